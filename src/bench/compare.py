@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+# Copyright 08.02.2023 Dmitry S
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Compares two Google Benchmark JSON files of the micro suite.
+
+Usage: compare.py BASELINE CURRENT [--threshold 0.10]
+
+Prints the time ratio of every benchmark present in both files and exits
+with status 1 when any of them got slower by more than the threshold or
+started allocating more matrices per operation.
+"""
+
+import argparse
+import json
+import sys
+
+UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path):
+    """Maps benchmark name to (time in ns, allocations per op)."""
+    with open(path) as file:
+        data = json.load(file)
+    results = {}
+    for run in data["benchmarks"]:
+        if run.get("run_type") == "aggregate":
+            continue
+        time = run["real_time"] * UNITS[run.get("time_unit", "ns")]
+        allocations = run.get("allocs/op", 0.0)
+        name = run["name"]
+        # Repetitions: keep the fastest, the least noisy estimate
+        if name not in results or time < results[name][0]:
+            results[name] = (time, allocations)
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="allowed slowdown, 0.10 is 10%%")
+    args = parser.parse_args()
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = []
+    print("%-44s %12s %12s %8s" % ("Benchmark", "Baseline ns", "Current ns",
+                                   "Ratio"))
+    for name, (time, allocations) in current.items():
+        if name not in baseline:
+            print("%-44s %12s %12.0f %8s" % (name, "-", time, "new"))
+            continue
+        base_time, base_allocations = baseline[name]
+        ratio = time / base_time
+        flags = []
+        if ratio > 1 + args.threshold:
+            flags.append("SLOWER")
+        if allocations > base_allocations + 0.5:
+            flags.append("MORE ALLOCATIONS (%.1f -> %.1f)" %
+                         (base_allocations, allocations))
+        if flags:
+            regressions.append(name)
+        line = "%-44s %12.0f %12.0f %8.2f %s" % (name, base_time, time, ratio,
+                                                 " ".join(flags))
+        print(line.rstrip())
+    for name in baseline:
+        if name not in current:
+            print("%-44s %12.0f %12s %8s" % (name, baseline[name][0], "-",
+                                             "missing"))
+
+    if regressions:
+        print("\n%d regression(s) beyond %.0f%%:" %
+              (len(regressions), args.threshold * 100))
+        for name in regressions:
+            print("  " + name)
+        return 1
+    print("\nNo regressions beyond %.0f%%" % (args.threshold * 100))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
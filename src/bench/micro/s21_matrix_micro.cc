@@ -0,0 +1,445 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Google Benchmark suite over the public operations. Every benchmark
+// reports GFLOP/s, the bytes one operation moves and the matrix buffers
+// it allocates; `make microbench` writes the results to bench.json and
+// bench/compare.py diffs two such files.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../s21_cholesky.h"
+#include "../../s21_fixed_matrix.h"
+#include "../../s21_lu.h"
+#include "../../s21_matrix_batch.h"
+#include "../../s21_matrix_io.h"
+#include "../../s21_matrix_oop.h"
+#include "../../s21_qr.h"
+#include "../../s21_result_cache.h"
+#include "../../s21_sparse_matrix.h"
+
+namespace {
+
+template <typename T = double>
+S21BasicMatrix<T> RandomMatrix(int rows, int cols) {
+  std::mt19937 gen(21);
+  std::uniform_real_distribution<T> dist(-1.0, 1.0);
+  S21BasicMatrix<T> result(rows, cols);
+  for (int i = 0; i < rows; i++) {
+    for (int j = 0; j < cols; j++) {
+      result(i, j) = dist(gen);
+    }
+  }
+  return result;
+}
+
+// Diagonally dominant, so every factorization and inverse exists
+S21Matrix WellConditioned(int n) {
+  S21Matrix result = RandomMatrix(n, n);
+  for (int i = 0; i < n; i++) {
+    result(i, i) += n;
+  }
+  return result;
+}
+
+// Runs body once per iteration and sets the counters shared by the suite.
+// flops and bytes are per operation.
+template <typename Body>
+void Measure(benchmark::State& state, double flops, double bytes,
+             Body body) {
+  long allocations = S21Matrix::GetAllocationCount();
+  for (auto _ : state) {
+    body();
+  }
+  allocations = S21Matrix::GetAllocationCount() - allocations;
+  state.counters["GFLOP"] = benchmark::Counter(
+      flops * 1e-9, benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["bytes/op"] = bytes;
+  state.counters["allocs/op"] =
+      benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+}
+
+// Element-wise
+
+void BM_EqMatrix(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(n, n);
+  S21Matrix b = a;
+  Measure(state, n * n, 16.0 * n * n,
+          [&] { benchmark::DoNotOptimize(a.EqMatrix(b)); });
+}
+BENCHMARK(BM_EqMatrix)->RangeMultiplier(4)->Range(16, 1024);
+
+// Arguments: size, S21Tolerance::Mode
+void BM_EqMatrixMode(benchmark::State& state) {
+  int n = state.range(0);
+  S21Tolerance tolerance{static_cast<S21Tolerance::Mode>(state.range(1)), 4};
+  S21Matrix a = RandomMatrix(n, n);
+  S21Matrix b = a;
+  Measure(state, n * n, 16.0 * n * n,
+          [&] { benchmark::DoNotOptimize(a.EqMatrix(b, tolerance)); });
+}
+BENCHMARK(BM_EqMatrixMode)
+    ->ArgsProduct({{64, 1024},
+                   {S21Tolerance::kAbsolute, S21Tolerance::kRelative,
+                    S21Tolerance::kUlp, S21Tolerance::kBitwise}});
+
+// The first elements differ, so only the first block is read
+void BM_EqMatrixMismatch(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(n, n);
+  S21Matrix b = a;
+  b(0, 0) += 1;
+  Measure(state, 0, 0, [&] { benchmark::DoNotOptimize(a.EqMatrix(b)); });
+}
+BENCHMARK(BM_EqMatrixMismatch)->Arg(1024);
+
+void BM_Hash(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(n, n);
+  Measure(state, 0, 8.0 * n * n,
+          [&] { benchmark::DoNotOptimize(a.Hash()); });
+}
+BENCHMARK(BM_Hash)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_SumMatrix(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(n, n);
+  S21Matrix b = RandomMatrix(n, n);
+  Measure(state, n * n, 24.0 * n * n, [&] { a.SumMatrix(b); });
+}
+BENCHMARK(BM_SumMatrix)->RangeMultiplier(4)->Range(4, 1024);
+
+void BM_SubMatrix(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(n, n);
+  S21Matrix b = RandomMatrix(n, n);
+  Measure(state, n * n, 24.0 * n * n, [&] { a.SubMatrix(b); });
+}
+BENCHMARK(BM_SubMatrix)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_MulNumber(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(n, n);
+  Measure(state, n * n, 16.0 * n * n, [&] { a.MulNumber(1.0000001); });
+}
+BENCHMARK(BM_MulNumber)->RangeMultiplier(4)->Range(16, 1024);
+
+// c = a + b * 2 as one fused pass into an existing matrix
+void BM_Expression(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(n, n);
+  S21Matrix b = RandomMatrix(n, n);
+  S21Matrix c(n, n);
+  Measure(state, 2.0 * n * n, 24.0 * n * n, [&] { c = a + b * 2; });
+}
+BENCHMARK(BM_Expression)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_ViewSum(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(2 * n, 2 * n);
+  S21Matrix b = RandomMatrix(n, n);
+  S21MatrixView quarter = a.View(n / 2, n / 2, n, n);
+  Measure(state, n * n, 24.0 * n * n, [&] { quarter += b; });
+}
+BENCHMARK(BM_ViewSum)->RangeMultiplier(4)->Range(16, 1024);
+
+// Products
+
+void BM_MulMatrix(benchmark::State& state) {
+  int m = state.range(0);
+  int k = state.range(1);
+  int n = state.range(2);
+  S21Matrix a = RandomMatrix(m, k);
+  S21Matrix b = RandomMatrix(k, n);
+  Measure(state, 2.0 * m * k * n, 8.0 * (m * k + k * n + m * n), [&] {
+    S21Matrix c = a * b;
+    benchmark::DoNotOptimize(c);
+  });
+}
+BENCHMARK(BM_MulMatrix)
+    ->ArgNames({"m", "k", "n"})
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      for (int n = 16; n <= 1024; n *= 4) {
+        b->Args({n, n, n});
+      }
+      // Rectangular shapes: outer product, inner product, matrix-vector
+      b->Args({1024, 16, 1024})->Args({16, 1024, 16})->Args({1024, 1024, 1});
+    });
+
+void BM_MulMatrixF(benchmark::State& state) {
+  int n = state.range(0);
+  S21MatrixF a = RandomMatrix<float>(n, n);
+  S21MatrixF b = RandomMatrix<float>(n, n);
+  Measure(state, 2.0 * n * n * n, 12.0 * n * n, [&] {
+    S21MatrixF c = a * b;
+    benchmark::DoNotOptimize(c);
+  });
+}
+BENCHMARK(BM_MulMatrixF)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_TransposedProduct(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(n, n);
+  S21Matrix b = RandomMatrix(n, n);
+  Measure(state, 2.0 * n * n * n, 24.0 * n * n, [&] {
+    S21Matrix c = a.TransposedView() * b;
+    benchmark::DoNotOptimize(c);
+  });
+}
+BENCHMARK(BM_TransposedProduct)->RangeMultiplier(4)->Range(16, 1024);
+
+// Transpose
+
+void BM_Transpose(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(n, n);
+  Measure(state, 0, 16.0 * n * n, [&] {
+    S21Matrix t = a.Transpose();
+    benchmark::DoNotOptimize(t);
+  });
+}
+BENCHMARK(BM_Transpose)->RangeMultiplier(4)->Range(16, 4096);
+
+void BM_TransposeInPlace(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(n, n);
+  Measure(state, 0, 16.0 * n * n, [&] { a.TransposeInPlace(); });
+}
+BENCHMARK(BM_TransposeInPlace)->RangeMultiplier(4)->Range(16, 4096);
+
+// Builds an n x 16 matrix a row at a time, as a streaming design matrix is
+void BM_AppendRow(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix row = RandomMatrix(1, 16);
+  Measure(state, 0, 2.0 * 8 * 16 * n, [&] {
+    S21Matrix a(1, 16);
+    for (int i = 1; i < n; i++) {
+      a.AppendRow(row);
+    }
+    benchmark::DoNotOptimize(a);
+  });
+}
+BENCHMARK(BM_AppendRow)->RangeMultiplier(8)->Range(64, 32768);
+
+// Algebra
+
+void BM_Determinant(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = WellConditioned(n);
+  Measure(state, 2.0 / 3 * n * n * n, 8.0 * n * n,
+          [&] { benchmark::DoNotOptimize(a.Determinant()); });
+}
+BENCHMARK(BM_Determinant)->RangeMultiplier(4)->Range(4, 1024);
+
+void BM_InverseMatrix(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = WellConditioned(n);
+  Measure(state, 2.0 * n * n * n, 16.0 * n * n, [&] {
+    S21Matrix inverse = a.InverseMatrix();
+    benchmark::DoNotOptimize(inverse);
+  });
+}
+BENCHMARK(BM_InverseMatrix)->RangeMultiplier(4)->Range(4, 1024);
+
+void BM_CalcComplements(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = WellConditioned(n);
+  Measure(state, 2.0 * n * n * n, 16.0 * n * n, [&] {
+    S21Matrix complements = a.CalcComplements();
+    benchmark::DoNotOptimize(complements);
+  });
+}
+BENCHMARK(BM_CalcComplements)->RangeMultiplier(4)->Range(4, 256);
+
+// Repeated calls on an unmodified matrix: every call after the first is a
+// memoized hash, a bitwise check against the stored operand and a copy
+void BM_InverseMatrixCached(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = WellConditioned(n);
+  S21ResultCache cache(64 << 20);
+  S21Matrix::SetResultCache(&cache);
+  a.InverseMatrix();
+  Measure(state, 0, 24.0 * n * n, [&] {
+    S21Matrix inverse = a.InverseMatrix();
+    benchmark::DoNotOptimize(inverse);
+  });
+  S21Matrix::SetResultCache(nullptr);
+}
+BENCHMARK(BM_InverseMatrixCached)->RangeMultiplier(4)->Range(4, 1024);
+
+void BM_Solve(benchmark::State& state) {
+  int n = state.range(0);
+  int rhs = state.range(1);
+  S21Matrix a = WellConditioned(n);
+  S21Matrix b = RandomMatrix(n, rhs);
+  Measure(state, 2.0 / 3 * n * n * n + 2.0 * n * n * rhs,
+          8.0 * (n * n + 2 * n * rhs), [&] {
+            S21Matrix x = a.Solve(b);
+            benchmark::DoNotOptimize(x);
+          });
+}
+BENCHMARK(BM_Solve)
+    ->ArgNames({"n", "rhs"})
+    ->ArgsProduct({benchmark::CreateRange(16, 1024, 4), {1, 64}});
+
+void BM_LUSolve(benchmark::State& state) {
+  int n = state.range(0);
+  S21LU lu(WellConditioned(n));
+  S21Matrix b = RandomMatrix(n, 1);
+  Measure(state, 2.0 * n * n, 8.0 * (n * n + 2 * n), [&] {
+    S21Matrix x = lu.Solve(b);
+    benchmark::DoNotOptimize(x);
+  });
+}
+BENCHMARK(BM_LUSolve)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_Cholesky(benchmark::State& state) {
+  int n = state.range(0);
+  S21Matrix a = RandomMatrix(n, n);
+  S21Matrix spd = a.Transpose() * a;
+  for (int i = 0; i < n; i++) {
+    spd(i, i) += n;
+  }
+  Measure(state, 1.0 / 3 * n * n * n, 16.0 * n * n, [&] {
+    S21Cholesky cholesky(spd);
+    benchmark::DoNotOptimize(cholesky);
+  });
+}
+BENCHMARK(BM_Cholesky)->RangeMultiplier(4)->Range(16, 1024);
+
+void BM_QR(benchmark::State& state) {
+  int m = state.range(0);
+  int n = state.range(1);
+  S21Matrix a = RandomMatrix(m, n);
+  Measure(state, 2.0 * m * n * n - 2.0 / 3 * n * n * n, 16.0 * m * n, [&] {
+    S21QR qr(a);
+    benchmark::DoNotOptimize(qr);
+  });
+}
+BENCHMARK(BM_QR)->ArgNames({"m", "n"})->Args({64, 64})->Args({256, 256})
+    ->Args({1024, 64})->Args({4096, 256});
+
+void BM_FixedInverse(benchmark::State& state) {
+  S21FixedMatrix<4, 4> a(WellConditioned(4));
+  Measure(state, 2.0 * 64, 256, [&] {
+    benchmark::DoNotOptimize(a.InverseMatrix());
+  });
+}
+BENCHMARK(BM_FixedInverse);
+
+// Sparse
+
+S21SparseMatrix RandomSparse(int n, double density) {
+  std::mt19937 gen(21);
+  std::uniform_int_distribution<int> index(0, n - 1);
+  std::uniform_real_distribution<double> value(-1.0, 1.0);
+  std::vector<S21SparseEntry<double>> entries;
+  long count = static_cast<long>(density * n * n);
+  for (long e = 0; e < count; e++) {
+    entries.push_back({index(gen), index(gen), value(gen)});
+  }
+  return S21SparseMatrix(n, n, std::move(entries));
+}
+
+void BM_SparseMulVector(benchmark::State& state) {
+  int n = state.range(0);
+  S21SparseMatrix a = RandomSparse(n, 0.01);
+  std::vector<double> x(n, 1.0);
+  std::vector<double> y(n);
+  double nonzeros = a.GetNonZeros();
+  Measure(state, 2 * nonzeros, 12 * nonzeros + 16.0 * n,
+          [&] { a.MulVector(x.data(), y.data()); });
+}
+BENCHMARK(BM_SparseMulVector)->RangeMultiplier(4)->Range(256, 16384);
+
+void BM_SparseProduct(benchmark::State& state) {
+  int n = state.range(0);
+  S21SparseMatrix a = RandomSparse(n, 0.01);
+  double nonzeros = a.GetNonZeros();
+  // Expected multiply-adds of two independent 1% matrices
+  Measure(state, 2 * nonzeros * nonzeros / n, 24 * nonzeros, [&] {
+    S21SparseMatrix c = a * a;
+    benchmark::DoNotOptimize(c);
+  });
+}
+BENCHMARK(BM_SparseProduct)->RangeMultiplier(4)->Range(256, 4096);
+
+// Batches of small matrices
+
+void BM_BatchMulMatrix(benchmark::State& state) {
+  int n = state.range(0);
+  int count = 4096;
+  S21MatrixBatch a(count, n, n);
+  for (int m = 0; m < count; m++) {
+    a.Set(m, WellConditioned(n));
+  }
+  S21MatrixBatch b = a;
+  Measure(state, 2.0 * n * n * n * count, 24.0 * n * n * count,
+          [&] { a *= b; });
+}
+BENCHMARK(BM_BatchMulMatrix)->DenseRange(4, 16, 4);
+
+void BM_BatchDeterminant(benchmark::State& state) {
+  int n = state.range(0);
+  int count = 4096;
+  S21MatrixBatch a(count, n, n);
+  for (int m = 0; m < count; m++) {
+    a.Set(m, WellConditioned(n));
+  }
+  Measure(state, 2.0 / 3 * n * n * n * count, 8.0 * n * n * count, [&] {
+    std::vector<double> determinants = a.Determinant();
+    benchmark::DoNotOptimize(determinants);
+  });
+}
+BENCHMARK(BM_BatchDeterminant)->DenseRange(4, 16, 4);
+
+void BM_BatchInverse(benchmark::State& state) {
+  int n = state.range(0);
+  int count = 4096;
+  S21MatrixBatch a(count, n, n);
+  for (int m = 0; m < count; m++) {
+    a.Set(m, WellConditioned(n));
+  }
+  Measure(state, 2.0 * n * n * n * count, 16.0 * n * n * count, [&] {
+    S21MatrixBatch inverse = a.InverseMatrix();
+    benchmark::DoNotOptimize(inverse);
+  });
+}
+BENCHMARK(BM_BatchInverse)->DenseRange(4, 16, 4);
+
+// Files
+
+void BM_SaveLoad(benchmark::State& state) {
+  int n = state.range(0);
+  std::string path = "/tmp/s21_matrix_micro.bin";
+  S21Matrix a = RandomMatrix(n, n);
+  Measure(state, 0, 16.0 * n * n, [&] {
+    a.Save(path);
+    S21Matrix loaded = S21Matrix::Load(path);
+    benchmark::DoNotOptimize(loaded);
+  });
+  std::remove(path.c_str());
+}
+BENCHMARK(BM_SaveLoad)->RangeMultiplier(4)->Range(64, 1024);
+
+}  // namespace
+
+BENCHMARK_MAIN();
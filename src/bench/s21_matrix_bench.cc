@@ -0,0 +1,400 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../s21_cholesky.h"
+#include "../s21_fixed_matrix.h"
+#include "../s21_gemm.h"
+#include "../s21_lu.h"
+#include "../s21_matrix_batch.h"
+#include "../s21_matrix_io.h"
+#include "../s21_matrix_oop.h"
+#include "../s21_memory.h"
+#include "../s21_sparse_matrix.h"
+#include "../s21_strassen.h"
+#include "../s21_thread_pool.h"
+
+namespace {
+
+template <typename T = double>
+S21BasicMatrix<T> RandomMatrix(int rows, int cols) {
+  std::mt19937 gen(21);
+  std::uniform_real_distribution<T> dist(-1.0, 1.0);
+  S21BasicMatrix<T> result(rows, cols);
+  for (int i = 0; i < rows; i++) {
+    for (int j = 0; j < cols; j++) {
+      result(i, j) = dist(gen);
+    }
+  }
+  return result;
+}
+
+template <typename Function>
+double TimeMs(Function function) {
+  auto start = std::chrono::steady_clock::now();
+  function();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void BenchDeterminant() {
+  for (int n : {100, 200, 500, 1000, 2000}) {
+    S21Matrix a = RandomMatrix(n, n);
+    double det = 0;
+    double ms = TimeMs([&] { det = a.Determinant(); });
+    double gflops = 2.0 / 3.0 * n * n * n / (ms * 1e6);
+    printf("Determinant %5dx%-5d %10.2f ms %8.2f GFLOP/s  (det %g)\n", n, n,
+           ms, gflops, det);
+  }
+}
+
+void BenchInverse() {
+  for (int n : {100, 200, 500, 1000}) {
+    S21Matrix a = RandomMatrix(n, n);
+    double ms = TimeMs([&] { a.InverseMatrix(); });
+    double gflops = 2.0 * n * n * n / (ms * 1e6);
+    printf("InverseMatrix %5dx%-5d %10.2f ms %8.2f GFLOP/s\n", n, n, ms,
+           gflops);
+  }
+}
+
+void BenchComplements() {
+  for (int n : {8, 100, 500}) {
+    S21Matrix a = RandomMatrix(n, n);
+    double ms = TimeMs([&] { a.CalcComplements(); });
+    printf("CalcComplements %5dx%-5d %10.2f ms\n", n, n, ms);
+  }
+}
+
+void BenchMulMatrix() {
+  printf("MulMatrix kernel: %s\n", s21::GemmKernelName());
+  for (int n : {128, 256, 512, 1024, 2048}) {
+    S21Matrix a = RandomMatrix(n, n);
+    S21Matrix b = RandomMatrix(n, n);
+    double ms = TimeMs([&] { a.MulMatrix(b); });
+    double gflops = 2.0 * n * n * n / (ms * 1e6);
+    printf("MulMatrix %5dx%-5d %10.2f ms %8.2f GFLOP/s\n", n, n, ms, gflops);
+  }
+}
+
+void BenchPrecision() {
+  for (int n : {512, 1024, 2048}) {
+    S21MatrixF a = RandomMatrix<float>(n, n);
+    S21MatrixF b = RandomMatrix<float>(n, n);
+    double float_ms = TimeMs([&] { a * b; });
+    double mixed_ms = TimeMs([&] { a.MulMatrixMixed(b); });
+    double flop = 2.0 * n * n * n / 1e6;
+    printf("MulMatrix %5dx%-5d  float %8.2f GFLOP/s  mixed %8.2f GFLOP/s\n",
+           n, n, flop / float_ms, flop / mixed_ms);
+  }
+}
+
+void BenchTranspose() {
+  for (int n : {1024, 4096}) {
+    S21Matrix a = RandomMatrix(n, n);
+    S21Matrix naive(n, n);
+    double naive_ms = TimeMs([&] {
+      for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+          naive(j, i) = a(i, j);
+        }
+      }
+    });
+    double blocked_ms = TimeMs([&] { a.Transpose(); });
+    double in_place_ms = TimeMs([&] { a.TransposeInPlace(); });
+    printf("Transpose %5dx%-5d naive %8.2f ms  blocked %8.2f ms  in place "
+           "%8.2f ms\n",
+           n, n, naive_ms, blocked_ms, in_place_ms);
+  }
+  int n = 1024;
+  S21Matrix a = RandomMatrix(n, n);
+  S21Matrix b = RandomMatrix(n, n);
+  double staged_ms = TimeMs([&] { a.Transpose() * b; });
+  double view_ms = TimeMs([&] { a.TransposedView() * b; });
+  printf("A^T * B %dx%d  transposed %8.2f ms  view %8.2f ms\n", n, n,
+         staged_ms, view_ms);
+}
+
+void BenchSparse() {
+  int n = 4096;
+  std::mt19937 gen(21);
+  std::uniform_int_distribution<int> index(0, n - 1);
+  // About 1% of the elements are nonzero
+  std::vector<S21SparseEntry<double>> entries;
+  for (long p = 0; p < static_cast<long>(n) * n / 100; p++) {
+    entries.push_back({index(gen), index(gen), 1.0});
+  }
+  S21SparseMatrix sparse(n, n, entries);
+  S21Matrix dense = sparse.ToDense();
+  std::vector<double> x(n, 1.0);
+  std::vector<double> y(n);
+  double spmv_ms = TimeMs([&] { sparse.MulVector(x.data(), y.data()); });
+  double dense_mv_ms = TimeMs([&] { dense * S21Matrix(n, 1); });
+  double spgemm_ms = TimeMs([&] { sparse * sparse; });
+  double sparse_bytes = sparse.GetNonZeros() * 12.0 + (n + 1) * 8.0;
+  printf("Sparse %dx%d 1%%  SpMV %8.3f ms (dense %8.2f ms)  SpGEMM %8.2f ms"
+         "  %.1f MB vs %.1f MB\n",
+         n, n, spmv_ms, dense_mv_ms, spgemm_ms, sparse_bytes / 1e6,
+         n * 8.0 * n / 1e6);
+}
+
+void BenchElementWise() {
+  int n = 4096;
+  S21Matrix a = RandomMatrix(n, n);
+  S21Matrix b = RandomMatrix(n, n);
+  S21Matrix c = RandomMatrix(n, n);
+  S21Matrix result(n, n);
+  double fused_ms = TimeMs([&] { result = a + b * 2.0 - c; });
+  double staged_ms = TimeMs([&] {
+    S21Matrix staged = b;
+    staged.MulNumber(2.0);
+    staged.SumMatrix(a);
+    staged.SubMatrix(c);
+    result = std::move(staged);
+  });
+  printf("A + B * 2 - C %dx%d  fused %9.2f ms  staged %9.2f ms\n", n, n,
+         fused_ms, staged_ms);
+}
+
+void BenchAllocators() {
+  const int count = 1000000;
+  auto churn = [&](std::pmr::memory_resource* resource,
+                   s21::ArenaResource* arena) {
+    return TimeMs([&] {
+      for (int i = 0; i < count; i++) {
+        S21Matrix a(4, 4, resource);
+        a(0, 0) = i;
+        if (arena != nullptr && i % 1000 == 999) {
+          arena->Reset();
+        }
+      }
+    });
+  };
+  s21::ArenaResource arena;
+  double heap_ms = churn(std::pmr::new_delete_resource(), nullptr);
+  double pool_ms = churn(s21::PoolResource::Instance(), nullptr);
+  double arena_ms = churn(&arena, &arena);
+  printf("4x4 create/destroy (M/s)  heap %6.2f  pool %6.2f  arena %6.2f\n",
+         count / heap_ms / 1e3, count / pool_ms / 1e3, count / arena_ms / 1e3);
+}
+
+void BenchFixed() {
+  const int count = 1000000;
+  S21Matrix dynamic = RandomMatrix(4, 4);
+  S21FixedMatrix<4, 4> fixed(dynamic);
+  volatile double sink = 0;
+  double dynamic_ms = TimeMs([&] {
+    for (int i = 0; i < count; i++) {
+      dynamic(0, 0) = i;
+      sink = sink + dynamic.InverseMatrix()(0, 0);
+    }
+  });
+  double fixed_ms = TimeMs([&] {
+    for (int i = 0; i < count; i++) {
+      fixed(0, 0) = i;
+      sink = sink + fixed.InverseMatrix()(0, 0);
+    }
+  });
+  printf("4x4 InverseMatrix  dynamic %7.1f ns  fixed %7.1f ns\n",
+         dynamic_ms * 1e6 / count, fixed_ms * 1e6 / count);
+}
+
+void BenchScaling() {
+  int max_threads = std::max(
+      s21::GetNumThreads(),
+      static_cast<int>(std::thread::hardware_concurrency()));
+  S21Matrix a = RandomMatrix(1024, 1024);
+  S21Matrix b = RandomMatrix(1024, 1024);
+  S21Matrix big = RandomMatrix(4096, 4096);
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    s21::SetNumThreads(threads);
+    S21Matrix product = a;
+    double mul_ms = TimeMs([&] { product.MulMatrix(b); });
+    double sum_ms = TimeMs([&] { big.SumMatrix(big); });
+    printf("Threads %3d  MulMatrix 1024 %9.2f ms  SumMatrix 4096 %9.2f ms\n",
+           threads, mul_ms, sum_ms);
+    if (threads < max_threads && threads * 2 > max_threads) {
+      threads = max_threads / 2;
+    }
+  }
+  s21::SetNumThreads(max_threads);
+}
+
+void BenchFiles() {
+  const char* path = "/tmp/s21_matrix_bench.bin";
+  int n = 4096;
+  S21Matrix a = RandomMatrix(n, n);
+  double save_ms = TimeMs([&] { a.Save(path); });
+  double load_ms = TimeMs([&] { S21Matrix::Load(path); });
+  volatile double sink = 0;
+  double map_ms = TimeMs([&] { sink = S21Matrix::MapFile(path)(0, 0); });
+  double touch_ms = TimeMs([&] {
+    S21MappedMatrix mapped = S21Matrix::MapFile(path);
+    for (int i = 0; i < n; i++) sink = sink + mapped(i, n - 1);
+  });
+  printf("File %dx%d  Save %8.2f ms  Load %8.2f ms  MapFile %6.3f ms  "
+         "map + touch rows %8.2f ms\n",
+         n, n, save_ms, load_ms, map_ms, touch_ms);
+  std::remove(path);
+
+  const char* a_path = "/tmp/s21_matrix_bench_a.bin";
+  const char* b_path = "/tmp/s21_matrix_bench_b.bin";
+  const char* c_path = "/tmp/s21_matrix_bench_c.bin";
+  n = 2048;
+  S21Matrix b = RandomMatrix(n, n);
+  S21Matrix c = RandomMatrix(n, n);
+  b.Save(a_path);
+  c.Save(b_path);
+  double in_memory_ms = TimeMs([&] { b * c; });
+  printf("MulMatrix %dx%d  in memory %9.2f ms", n, n, in_memory_ms);
+  for (size_t budget : {size_t(64) << 20, size_t(8) << 20}) {
+    double files_ms = TimeMs(
+        [&] { S21Matrix::MulFiles(a_path, b_path, c_path, budget); });
+    printf("  files, %2zu MB %9.2f ms", budget >> 20, files_ms);
+  }
+  printf("\n");
+  std::remove(a_path);
+  std::remove(b_path);
+  std::remove(c_path);
+}
+
+void BenchBatch() {
+  const int count = 20000;
+  for (int n : {4, 16}) {
+    std::vector<S21Matrix> singles;
+    S21MatrixBatch batch(count, n, n);
+    for (int m = 0; m < count; m++) {
+      singles.push_back(RandomMatrix(n, n));
+      for (int i = 0; i < n; i++) singles[m](i, i) += n;
+      batch.Set(m, singles[m]);
+    }
+    volatile double sink = 0;
+    double single_mul_ms = TimeMs([&] {
+      for (int m = 0; m < count; m++) {
+        sink = sink + (singles[m] * singles[m])(0, 0);
+      }
+    });
+    double single_det_ms = TimeMs([&] {
+      for (int m = 0; m < count; m++) sink = sink + singles[m].Determinant();
+    });
+    double single_inv_ms = TimeMs([&] {
+      for (int m = 0; m < count; m++) {
+        sink = sink + singles[m].InverseMatrix()(0, 0);
+      }
+    });
+    S21MatrixBatch product = batch;
+    double batch_mul_ms = TimeMs([&] { product *= batch; });
+    double batch_det_ms = TimeMs([&] { batch.Determinant(); });
+    double batch_inv_ms = TimeMs([&] { batch.InverseMatrix(); });
+    printf("%d x %2dx%-2d  MulMatrix %7.2f / %6.2f ms  Determinant %7.2f / "
+           "%6.2f ms  InverseMatrix %7.2f / %6.2f ms (single / batch)\n",
+           count, n, n, single_mul_ms, batch_mul_ms, single_det_ms,
+           batch_det_ms, single_inv_ms, batch_inv_ms);
+  }
+}
+
+void BenchSolve() {
+  int n = 1000;
+  S21Matrix a = RandomMatrix(n, n);
+  S21Matrix spd = a.Transpose() * a;
+  for (int i = 0; i < n; i++) spd(i, i) += n;
+  for (int rhs : {1, 100}) {
+    S21Matrix b = RandomMatrix(n, rhs);
+    double inverse_ms = TimeMs([&] { a.InverseMatrix() * b; });
+    double solve_ms = TimeMs([&] { a.Solve(b); });
+    S21LU lu(a);
+    double reuse_ms = TimeMs([&] { lu.Solve(b); });
+    double lu_spd_ms = TimeMs([&] { spd.Solve(b); });
+    double cholesky_ms = TimeMs([&] { S21Cholesky(spd).Solve(b); });
+    printf("Solve %dx%d, %3d rhs  inverse * b %8.2f ms  Solve %8.2f ms  "
+           "reused LU %7.2f ms  SPD: LU %8.2f ms  Cholesky %8.2f ms\n",
+           n, n, rhs, inverse_ms, solve_ms, reuse_ms, lu_spd_ms, cholesky_ms);
+  }
+  S21Matrix tall = RandomMatrix(4 * n, n / 4);
+  S21Matrix y = RandomMatrix(4 * n, 1);
+  double qr_ms = TimeMs([&] { tall.Solve(y); });
+  printf("Least squares %dx%d  QR %8.2f ms\n", 4 * n, n / 4, qr_ms);
+}
+
+// Largest deviation from the double-accumulated product, relative to its
+// largest element
+double RelativeError(const S21MatrixF& c, const S21Matrix& reference) {
+  double error = 0;
+  double scale = 0;
+  for (int i = 0; i < c.GetRows(); i++) {
+    for (int j = 0; j < c.GetCols(); j++) {
+      double value = reference(i, j);
+      error = std::max(error, fabs(c(i, j) - value));
+      scale = std::max(scale, fabs(value));
+    }
+  }
+  return error / scale;
+}
+
+void BenchStrassen() {
+  int crossover = s21::GetStrassenCrossover();
+  for (int n : {1024, 2048, 4096}) {
+    S21Matrix a = RandomMatrix(n, n);
+    S21Matrix b = RandomMatrix(n, n);
+    s21::SetStrassenCrossover(0);
+    double classic_ms = TimeMs([&] { a * b; });
+    s21::SetStrassenCrossover(crossover);
+    double strassen_ms = TimeMs([&] { a * b; });
+    printf("MulMatrix %5dx%-5d  classic %9.2f ms  Strassen %9.2f ms "
+           "(crossover %d)\n",
+           n, n, classic_ms, strassen_ms, crossover);
+  }
+  for (int n : {1024, 2048}) {
+    S21MatrixF a = RandomMatrix<float>(n, n);
+    S21MatrixF b = RandomMatrix<float>(n, n);
+    S21Matrix reference = a.MulMatrixMixed(b);
+    s21::SetStrassenCrossover(0);
+    double classic = RelativeError(a * b, reference);
+    for (int size : {crossover, crossover / 4}) {
+      s21::SetStrassenCrossover(size);
+      printf("MulMatrix float %5dx%-5d  relative error classic %.2e  "
+             "Strassen %.2e (crossover %d)\n",
+             n, n, classic, RelativeError(a * b, reference), size);
+    }
+  }
+  s21::SetStrassenCrossover(crossover);
+}
+
+}  // namespace
+
+int main() {
+  BenchDeterminant();
+  BenchInverse();
+  BenchComplements();
+  BenchMulMatrix();
+  BenchPrecision();
+  BenchTranspose();
+  BenchSparse();
+  BenchElementWise();
+  BenchAllocators();
+  BenchFixed();
+  BenchScaling();
+  BenchFiles();
+  BenchBatch();
+  BenchSolve();
+  BenchStrassen();
+  return 0;
+}
@@ -0,0 +1,133 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_cholesky.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "s21_thread_pool.h"
+
+// Constructors
+template <typename T>
+S21BasicCholesky<T>::S21BasicCholesky(S21BasicMatrix<T> A) : l_(std::move(A)) {
+  if (l_.cols_ != l_.rows_) {
+    throw std::invalid_argument("The matrix is not square");
+  }
+  S21_PROFILE(s21::Operation::kCholesky, l_.rows_, l_.cols_,
+              1.0 / 3 * l_.rows_ * l_.Size(), 2.0 * sizeof(T) * l_.Size());
+  Factorize();
+}
+
+// Accessors
+template <typename T>
+int S21BasicCholesky<T>::GetSize() const { return l_.rows_; }
+
+template <typename T>
+const S21BasicMatrix<T>& S21BasicCholesky<T>::GetFactor() const {
+  return l_;
+}
+
+// Algebra
+template <typename T>
+T S21BasicCholesky<T>::Determinant() const {
+  T result = 1;
+  for (int i = 0; i < l_.rows_; i++) {
+    result *= l_.Row(i)[i] * l_.Row(i)[i];
+  }
+  return result;
+}
+
+template <typename T>
+S21BasicMatrix<T> S21BasicCholesky<T>::Solve(
+    const S21BasicMatrix<T>& b) const {
+  if (b.rows_ != l_.rows_) {
+    throw std::invalid_argument("Different matrix dimensions");
+  }
+  S21_PROFILE(s21::Operation::kSolve, b.rows_, b.cols_,
+              2.0 * l_.Size() * b.cols_,
+              sizeof(T) * (l_.Size() + 2.0 * b.Size()));
+  int n = l_.rows_;
+  S21BasicMatrix<T> result = b;
+  // Bands of right-hand sides in parallel, as in S21LU::Solve
+  long work = static_cast<long>(n) * n * result.cols_;
+  s21::ParallelFor(0, result.cols_, work, [&](long lo, long hi) {
+    for (int i = 0; i < n; i++) {
+      T* row_i = result.Row(i);
+      const T* l_i = l_.Row(i);
+      for (int k = 0; k < i; k++) {
+        const T* row_k = result.Row(k);
+        for (long j = lo; j < hi; j++) {
+          row_i[j] -= l_i[k] * row_k[j];
+        }
+      }
+      for (long j = lo; j < hi; j++) {
+        row_i[j] /= l_i[i];
+      }
+    }
+    for (int i = n - 1; i >= 0; i--) {
+      T* row_i = result.Row(i);
+      for (int k = i + 1; k < n; k++) {
+        T factor = l_.Row(k)[i];
+        const T* row_k = result.Row(k);
+        for (long j = lo; j < hi; j++) {
+          row_i[j] -= factor * row_k[j];
+        }
+      }
+      T diagonal = l_.Row(i)[i];
+      for (long j = lo; j < hi; j++) {
+        row_i[j] /= diagonal;
+      }
+    }
+  });
+  return result;
+}
+
+// Extra functions
+// Column by column: L(i, k) is A(i, k) minus the dot product of the
+// leading parts of rows i and k, both contiguous, so the rows below the
+// diagonal are independent and split across threads
+template <typename T>
+void S21BasicCholesky<T>::Factorize() {
+  int n = l_.rows_;
+  for (int k = 0; k < n; k++) {
+    T* row_k = l_.Row(k);
+    T diagonal = row_k[k];
+    for (int p = 0; p < k; p++) {
+      diagonal -= row_k[p] * row_k[p];
+    }
+    if (!(diagonal > 0)) {
+      throw std::invalid_argument("The matrix is not positive definite");
+    }
+    diagonal = std::sqrt(diagonal);
+    row_k[k] = diagonal;
+    std::fill(row_k + k + 1, row_k + n, 0);
+    long work = static_cast<long>(n - k) * k;
+    s21::ParallelFor(k + 1, n, work, [&](long lo, long hi) {
+      for (long i = lo; i < hi; i++) {
+        T* row_i = l_.Row(i);
+        T sum = row_i[k];
+        for (int p = 0; p < k; p++) {
+          sum -= row_i[p] * row_k[p];
+        }
+        row_i[k] = sum / diagonal;
+      }
+    });
+  }
+}
+
+template class S21BasicCholesky<float>;
+template class S21BasicCholesky<double>;
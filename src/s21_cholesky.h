@@ -0,0 +1,54 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_CHOLESKY_H_
+#define S21_CHOLESKY_H_
+
+#include "s21_matrix_oop.h"
+
+// Cholesky factorization of a symmetric positive definite matrix:
+// A = L * L^T. Only the lower triangle of A is read. It takes half the
+// work of LU and needs no pivoting.
+template <typename T>
+class S21BasicCholesky {
+ public:
+  // Constructors
+  // Throws if A is not positive definite
+  explicit S21BasicCholesky(S21BasicMatrix<T> A);
+
+  // Accessors
+  int GetSize() const;
+  // L, with zeros above the diagonal
+  const S21BasicMatrix<T>& GetFactor() const;
+
+  // Algebra
+  T Determinant() const;
+  // X with A * X = B, by forward substitution with L and back
+  // substitution with L^T
+  S21BasicMatrix<T> Solve(const S21BasicMatrix<T>& b) const;
+
+ private:
+  S21BasicMatrix<T> l_;
+
+  // Extra functions
+  void Factorize();
+};
+
+using S21Cholesky = S21BasicCholesky<double>;
+using S21CholeskyF = S21BasicCholesky<float>;
+
+extern template class S21BasicCholesky<float>;
+extern template class S21BasicCholesky<double>;
+#endif  // S21_CHOLESKY_H_
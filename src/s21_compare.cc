@@ -0,0 +1,460 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_compare.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define S21_COMPARE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace s21 {
+
+namespace {
+
+// Elements compared between two checks for a mismatch
+constexpr long kBlock = 16;
+
+// Checks n elements against an absolute limit, or against limit times
+// the larger magnitude when kRelative
+template <typename T>
+using CloseKernel = bool (*)(const T* a, const T* b, long n, T limit);
+
+// Checks n elements against a limit on their distance in units in the
+// last place
+template <typename T>
+using UlpKernel = bool (*)(const T* a, const T* b, long n, uint64_t limit);
+
+template <typename T>
+struct KernelInfo {
+  CloseKernel<T> absolute;
+  CloseKernel<T> relative;
+  UlpKernel<T> ulp;
+  const char* name;
+};
+
+template <bool kRelative, typename T>
+bool Far(T a, T b, T limit) {
+  T bound = kRelative ? limit * std::max(fabs(a), fabs(b)) : limit;
+  return fabs(a - b) > bound;
+}
+
+// Branch-free inside a block so that the compiler can vectorize it
+template <bool kRelative, typename T>
+bool CloseGeneric(const T* a, const T* b, long n, T limit) {
+  long i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    bool far = false;
+    for (long k = i; k < i + kBlock; k++) {
+      far |= Far<kRelative>(a[k], b[k], limit);
+    }
+    if (far) return false;
+  }
+  for (; i < n; i++) {
+    if (Far<kRelative>(a[i], b[i], limit)) return false;
+  }
+  return true;
+}
+
+template <typename T>
+bool CloseUlp(const T* a, const T* b, long n, uint64_t limit) {
+  long i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    bool far = false;
+    for (long k = i; k < i + kBlock; k++) {
+      far |= UlpDistance(OrderedBits(a[k]), OrderedBits(b[k])) > limit;
+    }
+    if (far) return false;
+  }
+  for (; i < n; i++) {
+    if (UlpDistance(OrderedBits(a[i]), OrderedBits(b[i])) > limit) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#ifdef S21_COMPARE_X86
+template <bool kRelative>
+bool CloseSse2(const double* a, const double* b, long n, double limit) {
+  const __m128d sign = _mm_set1_pd(-0.0);
+  const __m128d scale = _mm_set1_pd(limit);
+  long i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128d far = _mm_setzero_pd();
+    for (int k = 0; k < 8; k += 2) {
+      __m128d x = _mm_loadu_pd(a + i + k);
+      __m128d y = _mm_loadu_pd(b + i + k);
+      __m128d bound = scale;
+      if (kRelative) {
+        bound = _mm_mul_pd(scale, _mm_max_pd(_mm_andnot_pd(sign, x),
+                                             _mm_andnot_pd(sign, y)));
+      }
+      __m128d diff = _mm_andnot_pd(sign, _mm_sub_pd(x, y));
+      far = _mm_or_pd(far, _mm_cmpgt_pd(diff, bound));
+    }
+    if (_mm_movemask_pd(far)) return false;
+  }
+  return CloseGeneric<kRelative>(a + i, b + i, n - i, limit);
+}
+
+template <bool kRelative>
+bool CloseSse2(const float* a, const float* b, long n, float limit) {
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  const __m128 scale = _mm_set1_ps(limit);
+  long i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128 far = _mm_setzero_ps();
+    for (int k = 0; k < 16; k += 4) {
+      __m128 x = _mm_loadu_ps(a + i + k);
+      __m128 y = _mm_loadu_ps(b + i + k);
+      __m128 bound = scale;
+      if (kRelative) {
+        bound = _mm_mul_ps(scale, _mm_max_ps(_mm_andnot_ps(sign, x),
+                                             _mm_andnot_ps(sign, y)));
+      }
+      __m128 diff = _mm_andnot_ps(sign, _mm_sub_ps(x, y));
+      far = _mm_or_ps(far, _mm_cmpgt_ps(diff, bound));
+    }
+    if (_mm_movemask_ps(far)) return false;
+  }
+  return CloseGeneric<kRelative>(a + i, b + i, n - i, limit);
+}
+
+template <bool kRelative>
+__attribute__((target("avx"))) bool CloseAvx(const double* a,
+                                             const double* b, long n,
+                                             double limit) {
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  const __m256d scale = _mm256_set1_pd(limit);
+  long i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256d far = _mm256_setzero_pd();
+    for (int k = 0; k < 16; k += 4) {
+      __m256d x = _mm256_loadu_pd(a + i + k);
+      __m256d y = _mm256_loadu_pd(b + i + k);
+      __m256d bound = scale;
+      if (kRelative) {
+        bound = _mm256_mul_pd(scale,
+                              _mm256_max_pd(_mm256_andnot_pd(sign, x),
+                                            _mm256_andnot_pd(sign, y)));
+      }
+      __m256d diff = _mm256_andnot_pd(sign, _mm256_sub_pd(x, y));
+      far = _mm256_or_pd(far, _mm256_cmp_pd(diff, bound, _CMP_GT_OQ));
+    }
+    if (_mm256_movemask_pd(far)) return false;
+  }
+  return CloseGeneric<kRelative>(a + i, b + i, n - i, limit);
+}
+
+template <bool kRelative>
+__attribute__((target("avx"))) bool CloseAvx(const float* a, const float* b,
+                                             long n, float limit) {
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  const __m256 scale = _mm256_set1_ps(limit);
+  long i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256 far = _mm256_setzero_ps();
+    for (int k = 0; k < 32; k += 8) {
+      __m256 x = _mm256_loadu_ps(a + i + k);
+      __m256 y = _mm256_loadu_ps(b + i + k);
+      __m256 bound = scale;
+      if (kRelative) {
+        bound = _mm256_mul_ps(scale,
+                              _mm256_max_ps(_mm256_andnot_ps(sign, x),
+                                            _mm256_andnot_ps(sign, y)));
+      }
+      __m256 diff = _mm256_andnot_ps(sign, _mm256_sub_ps(x, y));
+      far = _mm256_or_ps(far, _mm256_cmp_ps(diff, bound, _CMP_GT_OQ));
+    }
+    if (_mm256_movemask_ps(far)) return false;
+  }
+  return CloseGeneric<kRelative>(a + i, b + i, n - i, limit);
+}
+
+// The ULP kernels map both operands with OrderedBits and compare |x - y|
+// against the limit as unsigned integers, which holds the distance of
+// any two keys exactly. Compares are signed, so both sides are biased.
+__m128i OrderedBitsSse2(__m128i bits) {
+  __m128i sign = _mm_srai_epi32(bits, 31);
+  __m128i magnitude = _mm_and_si128(bits, _mm_set1_epi32(INT32_MAX));
+  return _mm_sub_epi32(_mm_xor_si128(magnitude, sign), sign);
+}
+
+// SSE2 has no 64-bit compare, so double precision stays scalar there
+bool CloseUlpSse2(const float* a, const float* b, long n, uint64_t limit) {
+  const __m128i bias = _mm_set1_epi32(INT32_MIN);
+  const __m128i bound = _mm_xor_si128(
+      _mm_set1_epi32(static_cast<int32_t>(std::min<uint64_t>(
+          limit, UINT32_MAX))),
+      bias);
+  long i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i far = _mm_setzero_si128();
+    for (int k = 0; k < 16; k += 4) {
+      __m128i x = OrderedBitsSse2(_mm_castps_si128(_mm_loadu_ps(a + i + k)));
+      __m128i y = OrderedBitsSse2(_mm_castps_si128(_mm_loadu_ps(b + i + k)));
+      __m128i less = _mm_cmpgt_epi32(y, x);
+      __m128i diff = _mm_sub_epi32(
+          _mm_xor_si128(_mm_sub_epi32(x, y), less), less);
+      far = _mm_or_si128(
+          far, _mm_cmpgt_epi32(_mm_xor_si128(diff, bias), bound));
+    }
+    if (_mm_movemask_epi8(far)) return false;
+  }
+  return CloseUlp(a + i, b + i, n - i, limit);
+}
+
+__attribute__((target("avx2"))) __m256i OrderedBitsAvx2(__m256i bits) {
+  __m256i sign = _mm256_srai_epi32(bits, 31);
+  __m256i magnitude = _mm256_and_si256(bits, _mm256_set1_epi32(INT32_MAX));
+  return _mm256_sub_epi32(_mm256_xor_si256(magnitude, sign), sign);
+}
+
+__attribute__((target("avx2"))) bool CloseUlpAvx2(const float* a,
+                                                  const float* b, long n,
+                                                  uint64_t limit) {
+  const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+  const __m256i bound = _mm256_xor_si256(
+      _mm256_set1_epi32(static_cast<int32_t>(std::min<uint64_t>(
+          limit, UINT32_MAX))),
+      bias);
+  long i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i far = _mm256_setzero_si256();
+    for (int k = 0; k < 32; k += 8) {
+      __m256i x = OrderedBitsAvx2(
+          _mm256_castps_si256(_mm256_loadu_ps(a + i + k)));
+      __m256i y = OrderedBitsAvx2(
+          _mm256_castps_si256(_mm256_loadu_ps(b + i + k)));
+      __m256i less = _mm256_cmpgt_epi32(y, x);
+      __m256i diff = _mm256_sub_epi32(
+          _mm256_xor_si256(_mm256_sub_epi32(x, y), less), less);
+      far = _mm256_or_si256(
+          far, _mm256_cmpgt_epi32(_mm256_xor_si256(diff, bias), bound));
+    }
+    if (!_mm256_testz_si256(far, far)) return false;
+  }
+  return CloseUlp(a + i, b + i, n - i, limit);
+}
+
+__attribute__((target("avx2"))) __m256i OrderedBitsAvx2Pd(__m256i bits) {
+  __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), bits);
+  __m256i magnitude = _mm256_and_si256(bits, _mm256_set1_epi64x(INT64_MAX));
+  return _mm256_sub_epi64(_mm256_xor_si256(magnitude, sign), sign);
+}
+
+__attribute__((target("avx2"))) bool CloseUlpAvx2(const double* a,
+                                                  const double* b, long n,
+                                                  uint64_t limit) {
+  const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i bound = _mm256_xor_si256(
+      _mm256_set1_epi64x(static_cast<int64_t>(limit)), bias);
+  long i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i far = _mm256_setzero_si256();
+    for (int k = 0; k < 16; k += 4) {
+      __m256i x = OrderedBitsAvx2Pd(
+          _mm256_castpd_si256(_mm256_loadu_pd(a + i + k)));
+      __m256i y = OrderedBitsAvx2Pd(
+          _mm256_castpd_si256(_mm256_loadu_pd(b + i + k)));
+      __m256i less = _mm256_cmpgt_epi64(y, x);
+      __m256i diff = _mm256_sub_epi64(
+          _mm256_xor_si256(_mm256_sub_epi64(x, y), less), less);
+      far = _mm256_or_si256(
+          far, _mm256_cmpgt_epi64(_mm256_xor_si256(diff, bias), bound));
+    }
+    if (!_mm256_testz_si256(far, far)) return false;
+  }
+  return CloseUlp(a + i, b + i, n - i, limit);
+}
+#endif
+
+template <typename T>
+const KernelInfo<T>& SelectKernel() {
+  static const KernelInfo<T> info = [] {
+#ifdef S21_COMPARE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return KernelInfo<T>{CloseAvx<false>, CloseAvx<true>, CloseUlpAvx2,
+                           "avx2"};
+    }
+    UlpKernel<T> ulp = CloseUlp<T>;
+    if constexpr (std::is_same<T, float>::value) ulp = CloseUlpSse2;
+    if (__builtin_cpu_supports("avx")) {
+      return KernelInfo<T>{CloseAvx<false>, CloseAvx<true>, ulp, "avx"};
+    }
+    return KernelInfo<T>{CloseSse2<false>, CloseSse2<true>, ulp, "sse2"};
+#else
+    return KernelInfo<T>{CloseGeneric<false, T>, CloseGeneric<true, T>,
+                         CloseUlp<T>, "generic"};
+#endif
+  }();
+  return info;
+}
+
+template <typename T>
+bool CloseArrays(const T* a, const T* b, long n,
+                 const S21Tolerance& tolerance) {
+  T limit = static_cast<T>(tolerance.limit);
+  switch (tolerance.mode) {
+    case S21Tolerance::kAbsolute:
+      return SelectKernel<T>().absolute(a, b, n, limit);
+    case S21Tolerance::kRelative:
+      return SelectKernel<T>().relative(a, b, n, limit);
+    case S21Tolerance::kUlp:
+      return SelectKernel<T>().ulp(a, b, n,
+                                   static_cast<uint64_t>(tolerance.limit));
+    default:
+      return memcmp(a, b, n * sizeof(T)) == 0;
+  }
+}
+
+template <typename T>
+bool CloseLayouts(const S21MatrixLayout<T>& a, const S21MatrixLayout<T>& b,
+                  const S21Tolerance& tolerance) {
+  if (a.data == b.data && a.row_stride == b.row_stride &&
+      a.col_stride == b.col_stride) {
+    // Every element is compared with itself
+    return true;
+  }
+  if (a.col_stride != 1 || b.col_stride != 1) {
+    for (long i = 0; i < a.rows; i++) {
+      for (long j = 0; j < a.cols; j++) {
+        if (!ElementClose(a.data[i * a.row_stride + j * a.col_stride],
+                          b.data[i * b.row_stride + j * b.col_stride],
+                          tolerance)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+  if (a.row_stride == a.cols && b.row_stride == b.cols) {
+    return CloseArrays(a.data, b.data, static_cast<long>(a.rows) * a.cols,
+                       tolerance);
+  }
+  for (long i = 0; i < a.rows; i++) {
+    if (!CloseArrays(a.data + i * a.row_stride, b.data + i * b.row_stride,
+                     a.cols, tolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+uint64_t RotateLeft(uint64_t x, int bits) {
+  return (x << bits) | (x >> (64 - bits));
+}
+
+uint64_t Read64(const unsigned char* p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t Read32(const unsigned char* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint64_t Round(uint64_t acc, uint64_t input) {
+  return RotateLeft(acc + input * kPrime2, 31) * kPrime1;
+}
+
+uint64_t MergeRound(uint64_t acc, uint64_t value) {
+  return (acc ^ Round(0, value)) * kPrime1 + kPrime4;
+}
+
+}  // namespace
+
+bool Close(const double* a, const double* b, long n,
+           const S21Tolerance& tolerance) {
+  return CloseArrays(a, b, n, tolerance);
+}
+
+bool Close(const float* a, const float* b, long n,
+           const S21Tolerance& tolerance) {
+  return CloseArrays(a, b, n, tolerance);
+}
+
+bool Close(const S21MatrixLayout<double>& a, const S21MatrixLayout<double>& b,
+           const S21Tolerance& tolerance) {
+  return CloseLayouts(a, b, tolerance);
+}
+
+bool Close(const S21MatrixLayout<float>& a, const S21MatrixLayout<float>& b,
+           const S21Tolerance& tolerance) {
+  return CloseLayouts(a, b, tolerance);
+}
+
+// Four independent lanes over 32-byte stripes keep the multipliers busy;
+// the lanes are folded together and the tail mixed in at the end
+uint64_t Hash(const void* data, size_t size, uint64_t seed) {
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  const unsigned char* end = p + size;
+  uint64_t hash;
+  if (size >= 32) {
+    uint64_t v1 = seed + kPrime1 + kPrime2;
+    uint64_t v2 = seed + kPrime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - kPrime1;
+    for (; p + 32 <= end; p += 32) {
+      v1 = Round(v1, Read64(p));
+      v2 = Round(v2, Read64(p + 8));
+      v3 = Round(v3, Read64(p + 16));
+      v4 = Round(v4, Read64(p + 24));
+    }
+    hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) +
+           RotateLeft(v4, 18);
+    hash = MergeRound(hash, v1);
+    hash = MergeRound(hash, v2);
+    hash = MergeRound(hash, v3);
+    hash = MergeRound(hash, v4);
+  } else {
+    hash = seed + kPrime5;
+  }
+  hash += size;
+  for (; p + 8 <= end; p += 8) {
+    hash = RotateLeft(hash ^ Round(0, Read64(p)), 27) * kPrime1 + kPrime4;
+  }
+  if (p + 4 <= end) {
+    hash = RotateLeft(hash ^ (Read32(p) * kPrime1), 23) * kPrime2 + kPrime3;
+    p += 4;
+  }
+  for (; p < end; p++) {
+    hash = RotateLeft(hash ^ (*p * kPrime5), 11) * kPrime1;
+  }
+  hash ^= hash >> 33;
+  hash *= kPrime2;
+  hash ^= hash >> 29;
+  hash *= kPrime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+const char* CompareKernelName() { return SelectKernel<double>().name; }
+
+}  // namespace s21
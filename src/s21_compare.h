@@ -0,0 +1,108 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_COMPARE_H_
+#define S21_COMPARE_H_
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "s21_matrix_expr.h"
+
+// How EqMatrix decides that two elements are equal
+struct S21Tolerance {
+  enum Mode { kAbsolute, kRelative, kUlp, kBitwise };
+
+  Mode mode;
+  double limit;
+
+  // |a - b| <= limit
+  static constexpr S21Tolerance Absolute(double limit) {
+    return {kAbsolute, limit};
+  }
+  // |a - b| <= limit * max(|a|, |b|)
+  static constexpr S21Tolerance Relative(double limit) {
+    return {kRelative, limit};
+  }
+  // At most limit representable values apart; +0 and -0 are equal
+  static constexpr S21Tolerance Ulps(double limit) { return {kUlp, limit}; }
+  // Same bit patterns, compared with memcmp
+  static constexpr S21Tolerance Bitwise() { return {kBitwise, 0}; }
+};
+
+namespace s21 {
+
+// Maps the bits of x to an integer that grows with x, so the distance
+// between two of them counts the representable values in between
+inline int64_t OrderedBits(double x) {
+  int64_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  return bits < 0 ? INT64_MIN - bits : bits;
+}
+
+inline int64_t OrderedBits(float x) {
+  int32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  return bits < 0 ? INT32_MIN - bits : bits;
+}
+
+inline uint64_t UlpDistance(int64_t a, int64_t b) {
+  return a > b ? static_cast<uint64_t>(a) - static_cast<uint64_t>(b)
+               : static_cast<uint64_t>(b) - static_cast<uint64_t>(a);
+}
+
+template <typename T>
+bool ElementClose(T a, T b, const S21Tolerance& tolerance) {
+  switch (tolerance.mode) {
+    case S21Tolerance::kAbsolute:
+      return !(fabs(a - b) > tolerance.limit);
+    case S21Tolerance::kRelative:
+      return !(fabs(a - b) > tolerance.limit * fmax(fabs(a), fabs(b)));
+    case S21Tolerance::kUlp:
+      return UlpDistance(OrderedBits(a), OrderedBits(b)) <=
+             static_cast<uint64_t>(tolerance.limit);
+    default:
+      return memcmp(&a, &b, sizeof(T)) == 0;
+  }
+}
+
+// True when every pair a[i], b[i] of the n elements is close. Elements
+// are checked a block at a time with vector instructions, and the scan
+// stops at the first block holding a mismatch.
+bool Close(const double* a, const double* b, long n,
+           const S21Tolerance& tolerance);
+bool Close(const float* a, const float* b, long n,
+           const S21Tolerance& tolerance);
+
+// Same for two matrices of the same shape; rows with a column stride of
+// 1 go through the vector kernels
+bool Close(const S21MatrixLayout<double>& a, const S21MatrixLayout<double>& b,
+           const S21Tolerance& tolerance);
+bool Close(const S21MatrixLayout<float>& a, const S21MatrixLayout<float>& b,
+           const S21Tolerance& tolerance);
+
+// 64-bit XXH64 of size bytes. Passing the previous result as the seed
+// chains several buffers into one hash.
+uint64_t Hash(const void* data, size_t size, uint64_t seed);
+
+// Name of the comparison kernels picked for this CPU ("avx2", "avx",
+// "sse2", "generic")
+const char* CompareKernelName();
+
+}  // namespace s21
+
+#endif  // S21_COMPARE_H_
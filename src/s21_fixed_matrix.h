@@ -0,0 +1,370 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_FIXED_MATRIX_H_
+#define S21_FIXED_MATRIX_H_
+
+#include <stdexcept>
+
+#include "s21_matrix_oop.h"
+
+// Matrix with dimensions fixed at compile time and elements stored inline,
+// for the small 2x2..4x4 cases of geometry code. Shape errors of products
+// and sums are compile errors; determinant and inverse are closed form up
+// to 4x4.
+template <int R, int C, typename T = double>
+class S21FixedMatrix {
+  static_assert(R > 0 && C > 0, "Rows and cols must be greater than 0");
+
+ public:
+  using Scalar = T;
+
+  // Constructors
+  constexpr S21FixedMatrix() : matrix_{} {}
+  explicit S21FixedMatrix(const S21BasicMatrix<T>& other) : matrix_{} {
+    if (other.rows_ != R || other.cols_ != C) {
+      throw std::invalid_argument("Different matrix dimensions");
+    }
+    for (int i = 0; i < R; i++) {
+      for (int j = 0; j < C; j++) {
+        matrix_[i][j] = other.Row(i)[j];
+      }
+    }
+  }
+
+  explicit operator S21BasicMatrix<T>() const {
+    S21BasicMatrix<T> result(R, C);
+    for (int i = 0; i < R; i++) {
+      for (int j = 0; j < C; j++) {
+        result.Row(i)[j] = matrix_[i][j];
+      }
+    }
+    return result;
+  }
+
+  // Mutators
+  static constexpr int GetRows() { return R; }
+  static constexpr int GetCols() { return C; }
+
+  // Equals
+  constexpr bool EqMatrix(const S21FixedMatrix& other) const {
+    for (int i = 0; i < R; i++) {
+      for (int j = 0; j < C; j++) {
+        if (Abs(matrix_[i][j] - other.matrix_[i][j]) >
+            S21ScalarTraits<T>::kTolerance) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Multiplication
+  constexpr void MulNumber(const T num) {
+    for (int i = 0; i < R; i++) {
+      for (int j = 0; j < C; j++) {
+        matrix_[i][j] *= num;
+      }
+    }
+  }
+
+  constexpr void MulMatrix(const S21FixedMatrix<C, C, T>& other) {
+    *this = *this * other;
+  }
+
+  // Sum
+  constexpr void SumMatrix(const S21FixedMatrix& other) {
+    for (int i = 0; i < R; i++) {
+      for (int j = 0; j < C; j++) {
+        matrix_[i][j] += other.matrix_[i][j];
+      }
+    }
+  }
+
+  // Sub
+  constexpr void SubMatrix(const S21FixedMatrix& other) {
+    for (int i = 0; i < R; i++) {
+      for (int j = 0; j < C; j++) {
+        matrix_[i][j] -= other.matrix_[i][j];
+      }
+    }
+  }
+
+  // Transpose
+  constexpr S21FixedMatrix<C, R, T> Transpose() const {
+    S21FixedMatrix<C, R, T> result;
+    for (int i = 0; i < R; i++) {
+      for (int j = 0; j < C; j++) {
+        result(j, i) = matrix_[i][j];
+      }
+    }
+    return result;
+  }
+
+  // Algebra
+  constexpr T Determinant() const {
+    static_assert(R == C, "The matrix is not square");
+    const auto& m = matrix_;
+    if constexpr (R == 1) {
+      return m[0][0];
+    } else if constexpr (R == 2) {
+      return m[0][0] * m[1][1] - m[0][1] * m[1][0];
+    } else if constexpr (R == 3) {
+      return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+             m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+             m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    } else if constexpr (R == 4) {
+      Pairs4 p = Pairs(m);
+      return p.s[0] * p.c[5] - p.s[1] * p.c[4] + p.s[2] * p.c[3] +
+             p.s[3] * p.c[2] - p.s[4] * p.c[1] + p.s[5] * p.c[0];
+    } else {
+      return EliminationDeterminant();
+    }
+  }
+
+  constexpr S21FixedMatrix InverseMatrix() const {
+    static_assert(R == C, "The matrix is not square");
+    T determinant = Determinant();
+    if (determinant == 0) {
+      throw std::invalid_argument("Matrix determinant is 0");
+    }
+    T d = 1 / determinant;
+    const auto& m = matrix_;
+    S21FixedMatrix result;
+    auto& r = result.matrix_;
+    if constexpr (R == 1) {
+      r[0][0] = d;
+    } else if constexpr (R == 2) {
+      r[0][0] = m[1][1] * d;
+      r[0][1] = -m[0][1] * d;
+      r[1][0] = -m[1][0] * d;
+      r[1][1] = m[0][0] * d;
+    } else if constexpr (R == 3) {
+      r[0][0] = (m[1][1] * m[2][2] - m[1][2] * m[2][1]) * d;
+      r[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * d;
+      r[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * d;
+      r[1][0] = (m[1][2] * m[2][0] - m[1][0] * m[2][2]) * d;
+      r[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * d;
+      r[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * d;
+      r[2][0] = (m[1][0] * m[2][1] - m[1][1] * m[2][0]) * d;
+      r[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * d;
+      r[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * d;
+    } else if constexpr (R == 4) {
+      Pairs4 p = Pairs(m);
+      const T* s = p.s;
+      const T* c = p.c;
+      r[0][0] = (m[1][1] * c[5] - m[1][2] * c[4] + m[1][3] * c[3]) * d;
+      r[0][1] = (-m[0][1] * c[5] + m[0][2] * c[4] - m[0][3] * c[3]) * d;
+      r[0][2] = (m[3][1] * s[5] - m[3][2] * s[4] + m[3][3] * s[3]) * d;
+      r[0][3] = (-m[2][1] * s[5] + m[2][2] * s[4] - m[2][3] * s[3]) * d;
+      r[1][0] = (-m[1][0] * c[5] + m[1][2] * c[2] - m[1][3] * c[1]) * d;
+      r[1][1] = (m[0][0] * c[5] - m[0][2] * c[2] + m[0][3] * c[1]) * d;
+      r[1][2] = (-m[3][0] * s[5] + m[3][2] * s[2] - m[3][3] * s[1]) * d;
+      r[1][3] = (m[2][0] * s[5] - m[2][2] * s[2] + m[2][3] * s[1]) * d;
+      r[2][0] = (m[1][0] * c[4] - m[1][1] * c[2] + m[1][3] * c[0]) * d;
+      r[2][1] = (-m[0][0] * c[4] + m[0][1] * c[2] - m[0][3] * c[0]) * d;
+      r[2][2] = (m[3][0] * s[4] - m[3][1] * s[2] + m[3][3] * s[0]) * d;
+      r[2][3] = (-m[2][0] * s[4] + m[2][1] * s[2] - m[2][3] * s[0]) * d;
+      r[3][0] = (-m[1][0] * c[3] + m[1][1] * c[1] - m[1][2] * c[0]) * d;
+      r[3][1] = (m[0][0] * c[3] - m[0][1] * c[1] + m[0][2] * c[0]) * d;
+      r[3][2] = (-m[3][0] * s[3] + m[3][1] * s[1] - m[3][2] * s[0]) * d;
+      r[3][3] = (m[2][0] * s[3] - m[2][1] * s[1] + m[2][2] * s[0]) * d;
+    } else {
+      result = EliminationInverse();
+    }
+    return result;
+  }
+
+  // Overloaded
+  constexpr T& operator()(int row, int col) {
+    if (row >= R || col >= C || row < 0 || col < 0) {
+      throw std::out_of_range("Index is outside the matrix");
+    }
+    return matrix_[row][col];
+  }
+
+  constexpr T operator()(int row, int col) const {
+    if (row >= R || col >= C || row < 0 || col < 0) {
+      throw std::out_of_range("Index is outside the matrix");
+    }
+    return matrix_[row][col];
+  }
+
+  constexpr bool operator==(const S21FixedMatrix& other) const {
+    return EqMatrix(other);
+  }
+
+  constexpr S21FixedMatrix operator+(const S21FixedMatrix& other) const {
+    S21FixedMatrix result = *this;
+    result.SumMatrix(other);
+    return result;
+  }
+
+  constexpr S21FixedMatrix operator-(const S21FixedMatrix& other) const {
+    S21FixedMatrix result = *this;
+    result.SubMatrix(other);
+    return result;
+  }
+
+  constexpr S21FixedMatrix operator*(const T num) const {
+    S21FixedMatrix result = *this;
+    result.MulNumber(num);
+    return result;
+  }
+
+  template <int K>
+  constexpr S21FixedMatrix<R, K, T> operator*(
+      const S21FixedMatrix<C, K, T>& other) const {
+    S21FixedMatrix<R, K, T> result;
+    for (int i = 0; i < R; i++) {
+      for (int k = 0; k < C; k++) {
+        T value = matrix_[i][k];
+        for (int j = 0; j < K; j++) {
+          result(i, j) += value * other(k, j);
+        }
+      }
+    }
+    return result;
+  }
+
+  constexpr S21FixedMatrix& operator+=(const S21FixedMatrix& other) {
+    SumMatrix(other);
+    return *this;
+  }
+
+  constexpr S21FixedMatrix& operator-=(const S21FixedMatrix& other) {
+    SubMatrix(other);
+    return *this;
+  }
+
+  constexpr S21FixedMatrix& operator*=(const T num) {
+    MulNumber(num);
+    return *this;
+  }
+
+  constexpr S21FixedMatrix& operator*=(const S21FixedMatrix<C, C, T>& other) {
+    MulMatrix(other);
+    return *this;
+  }
+
+ private:
+  T matrix_[R][C];
+
+  static constexpr T Abs(T value) {
+    return value < 0 ? -value : value;
+  }
+
+  // 2x2 determinants of the top (s) and bottom (c) row pairs of a 4x4
+  struct Pairs4 {
+    T s[6];
+    T c[6];
+  };
+
+  static constexpr Pairs4 Pairs(const T (&m)[R][C]) {
+    Pairs4 p{};
+    p.s[0] = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+    p.s[1] = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+    p.s[2] = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+    p.s[3] = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+    p.s[4] = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+    p.s[5] = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+    p.c[0] = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+    p.c[1] = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+    p.c[2] = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+    p.c[3] = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+    p.c[4] = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+    p.c[5] = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+    return p;
+  }
+
+  // Partial-pivoting elimination for sizes without a closed form
+  constexpr T EliminationDeterminant() const {
+    S21FixedMatrix a = *this;
+    T result = 1;
+    for (int k = 0; k < R; k++) {
+      int pivot = k;
+      for (int i = k + 1; i < R; i++) {
+        if (Abs(a.matrix_[i][k]) > Abs(a.matrix_[pivot][k])) {
+          pivot = i;
+        }
+      }
+      if (a.matrix_[pivot][k] == 0) {
+        return 0;
+      }
+      if (pivot != k) {
+        a.SwapRows(pivot, k);
+        result = -result;
+      }
+      result *= a.matrix_[k][k];
+      for (int i = k + 1; i < R; i++) {
+        T factor = a.matrix_[i][k] / a.matrix_[k][k];
+        for (int j = k; j < C; j++) {
+          a.matrix_[i][j] -= factor * a.matrix_[k][j];
+        }
+      }
+    }
+    return result;
+  }
+
+  constexpr S21FixedMatrix EliminationInverse() const {
+    S21FixedMatrix a = *this;
+    S21FixedMatrix result;
+    for (int i = 0; i < R; i++) {
+      result.matrix_[i][i] = 1;
+    }
+    for (int k = 0; k < R; k++) {
+      int pivot = k;
+      for (int i = k + 1; i < R; i++) {
+        if (Abs(a.matrix_[i][k]) > Abs(a.matrix_[pivot][k])) {
+          pivot = i;
+        }
+      }
+      a.SwapRows(pivot, k);
+      result.SwapRows(pivot, k);
+      T diagonal = a.matrix_[k][k];
+      for (int j = 0; j < C; j++) {
+        a.matrix_[k][j] /= diagonal;
+        result.matrix_[k][j] /= diagonal;
+      }
+      for (int i = 0; i < R; i++) {
+        T factor = a.matrix_[i][k];
+        if (i != k && factor != 0) {
+          for (int j = 0; j < C; j++) {
+            a.matrix_[i][j] -= factor * a.matrix_[k][j];
+            result.matrix_[i][j] -= factor * result.matrix_[k][j];
+          }
+        }
+      }
+    }
+    return result;
+  }
+
+  constexpr void SwapRows(int first, int second) {
+    for (int j = 0; j < C; j++) {
+      T temp = matrix_[first][j];
+      matrix_[first][j] = matrix_[second][j];
+      matrix_[second][j] = temp;
+    }
+  }
+};
+
+template <int R, int C, typename T>
+constexpr S21FixedMatrix<R, C, T> operator*(
+    const typename S21FixedMatrix<R, C, T>::Scalar num,
+    const S21FixedMatrix<R, C, T>& matrix) {
+  return matrix * num;
+}
+
+#endif  // S21_FIXED_MATRIX_H_
@@ -0,0 +1,429 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_gemm.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "s21_thread_pool.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define S21_GEMM_X86 1
+#include <immintrin.h>
+#endif
+
+namespace s21 {
+
+namespace {
+
+// Cache blocking: a kc x nc panel of B stays in L3, an mc x kc block of A
+// in L2 and one kc x nr sliver of B in L1 while the micro-kernel runs.
+constexpr int kBlockM = 96;
+constexpr int kBlockK = 256;
+// Bytes of the packed panel of B, kBlockK rows by up to block_n
+// columns. It is kept by each thread between products, so it is bounded.
+constexpr size_t kPackBytes = 1 << 20;
+constexpr int kMaxTile = 6 * 16;
+// Below this many multiply-adds packing costs more than it saves
+constexpr long kSmallProduct = 32 * 32 * 32;
+// Smallest tile edge worth handing to another thread
+constexpr int kMinTile = 64;
+
+// Computes an mr x nr tile of alpha * A * B + beta * C from packed panels
+template <typename T>
+using MicroKernel = void (*)(int kc, const T* a, const T* b, T* c, int ldc,
+                             T alpha, T beta);
+
+template <typename T>
+struct KernelInfo {
+  MicroKernel<T> kernel;
+  int mr;
+  int nr;
+  const char* name;
+};
+
+#ifndef S21_GEMM_X86
+template <typename T>
+void KernelGeneric(int kc, const T* a, const T* b, T* c, int ldc, T alpha,
+                   T beta) {
+  T acc[4][4] = {};
+  for (int p = 0; p < kc; p++) {
+    for (int i = 0; i < 4; i++) {
+      for (int j = 0; j < 4; j++) {
+        acc[i][j] += a[p * 4 + i] * b[p * 4 + j];
+      }
+    }
+  }
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      T* out = c + i * ldc + j;
+      *out = alpha * acc[i][j] + (beta == 0 ? 0 : beta * *out);
+    }
+  }
+}
+#else
+void KernelSse2(int kc, const double* a, const double* b, double* c, int ldc,
+                double alpha, double beta) {
+  __m128d acc[4][2];
+  for (int i = 0; i < 4; i++) {
+    acc[i][0] = acc[i][1] = _mm_setzero_pd();
+  }
+  for (int p = 0; p < kc; p++) {
+    __m128d b0 = _mm_loadu_pd(b + p * 4);
+    __m128d b1 = _mm_loadu_pd(b + p * 4 + 2);
+    for (int i = 0; i < 4; i++) {
+      __m128d ai = _mm_set1_pd(a[p * 4 + i]);
+      acc[i][0] = _mm_add_pd(acc[i][0], _mm_mul_pd(ai, b0));
+      acc[i][1] = _mm_add_pd(acc[i][1], _mm_mul_pd(ai, b1));
+    }
+  }
+  __m128d va = _mm_set1_pd(alpha);
+  __m128d vb = _mm_set1_pd(beta);
+  for (int i = 0; i < 4; i++) {
+    double* out = c + i * ldc;
+    for (int h = 0; h < 2; h++) {
+      __m128d r = _mm_mul_pd(va, acc[i][h]);
+      if (beta != 0) {
+        r = _mm_add_pd(r, _mm_mul_pd(vb, _mm_loadu_pd(out + 2 * h)));
+      }
+      _mm_storeu_pd(out + 2 * h, r);
+    }
+  }
+}
+
+void KernelSse2(int kc, const float* a, const float* b, float* c, int ldc,
+                float alpha, float beta) {
+  __m128 acc[4][2];
+  for (int i = 0; i < 4; i++) {
+    acc[i][0] = acc[i][1] = _mm_setzero_ps();
+  }
+  for (int p = 0; p < kc; p++) {
+    __m128 b0 = _mm_loadu_ps(b + p * 8);
+    __m128 b1 = _mm_loadu_ps(b + p * 8 + 4);
+    for (int i = 0; i < 4; i++) {
+      __m128 ai = _mm_set1_ps(a[p * 4 + i]);
+      acc[i][0] = _mm_add_ps(acc[i][0], _mm_mul_ps(ai, b0));
+      acc[i][1] = _mm_add_ps(acc[i][1], _mm_mul_ps(ai, b1));
+    }
+  }
+  __m128 va = _mm_set1_ps(alpha);
+  __m128 vb = _mm_set1_ps(beta);
+  for (int i = 0; i < 4; i++) {
+    float* out = c + i * ldc;
+    for (int h = 0; h < 2; h++) {
+      __m128 r = _mm_mul_ps(va, acc[i][h]);
+      if (beta != 0) {
+        r = _mm_add_ps(r, _mm_mul_ps(vb, _mm_loadu_ps(out + 4 * h)));
+      }
+      _mm_storeu_ps(out + 4 * h, r);
+    }
+  }
+}
+
+__attribute__((target("avx2,fma"))) void KernelAvx2(int kc, const double* a,
+                                                    const double* b, double* c,
+                                                    int ldc, double alpha,
+                                                    double beta) {
+  __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+  __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+  __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+  __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+  __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+  __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+  for (int p = 0; p < kc; p++) {
+    __m256d b0 = _mm256_loadu_pd(b);
+    __m256d b1 = _mm256_loadu_pd(b + 4);
+    __m256d ai = _mm256_broadcast_sd(a);
+    c00 = _mm256_fmadd_pd(ai, b0, c00);
+    c01 = _mm256_fmadd_pd(ai, b1, c01);
+    ai = _mm256_broadcast_sd(a + 1);
+    c10 = _mm256_fmadd_pd(ai, b0, c10);
+    c11 = _mm256_fmadd_pd(ai, b1, c11);
+    ai = _mm256_broadcast_sd(a + 2);
+    c20 = _mm256_fmadd_pd(ai, b0, c20);
+    c21 = _mm256_fmadd_pd(ai, b1, c21);
+    ai = _mm256_broadcast_sd(a + 3);
+    c30 = _mm256_fmadd_pd(ai, b0, c30);
+    c31 = _mm256_fmadd_pd(ai, b1, c31);
+    ai = _mm256_broadcast_sd(a + 4);
+    c40 = _mm256_fmadd_pd(ai, b0, c40);
+    c41 = _mm256_fmadd_pd(ai, b1, c41);
+    ai = _mm256_broadcast_sd(a + 5);
+    c50 = _mm256_fmadd_pd(ai, b0, c50);
+    c51 = _mm256_fmadd_pd(ai, b1, c51);
+    a += 6;
+    b += 8;
+  }
+  __m256d acc[6][2] = {{c00, c01}, {c10, c11}, {c20, c21},
+                       {c30, c31}, {c40, c41}, {c50, c51}};
+  __m256d va = _mm256_set1_pd(alpha);
+  __m256d vb = _mm256_set1_pd(beta);
+  for (int i = 0; i < 6; i++) {
+    double* out = c + i * ldc;
+    for (int h = 0; h < 2; h++) {
+      __m256d r = _mm256_mul_pd(va, acc[i][h]);
+      if (beta != 0) {
+        r = _mm256_fmadd_pd(vb, _mm256_loadu_pd(out + 4 * h), r);
+      }
+      _mm256_storeu_pd(out + 4 * h, r);
+    }
+  }
+}
+
+// Same 6-row shape as the double kernel with twice the lanes per register
+__attribute__((target("avx2,fma"))) void KernelAvx2(int kc, const float* a,
+                                                    const float* b, float* c,
+                                                    int ldc, float alpha,
+                                                    float beta) {
+  __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+  __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+  __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+  __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+  __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+  __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+  for (int p = 0; p < kc; p++) {
+    __m256 b0 = _mm256_loadu_ps(b);
+    __m256 b1 = _mm256_loadu_ps(b + 8);
+    __m256 ai = _mm256_broadcast_ss(a);
+    c00 = _mm256_fmadd_ps(ai, b0, c00);
+    c01 = _mm256_fmadd_ps(ai, b1, c01);
+    ai = _mm256_broadcast_ss(a + 1);
+    c10 = _mm256_fmadd_ps(ai, b0, c10);
+    c11 = _mm256_fmadd_ps(ai, b1, c11);
+    ai = _mm256_broadcast_ss(a + 2);
+    c20 = _mm256_fmadd_ps(ai, b0, c20);
+    c21 = _mm256_fmadd_ps(ai, b1, c21);
+    ai = _mm256_broadcast_ss(a + 3);
+    c30 = _mm256_fmadd_ps(ai, b0, c30);
+    c31 = _mm256_fmadd_ps(ai, b1, c31);
+    ai = _mm256_broadcast_ss(a + 4);
+    c40 = _mm256_fmadd_ps(ai, b0, c40);
+    c41 = _mm256_fmadd_ps(ai, b1, c41);
+    ai = _mm256_broadcast_ss(a + 5);
+    c50 = _mm256_fmadd_ps(ai, b0, c50);
+    c51 = _mm256_fmadd_ps(ai, b1, c51);
+    a += 6;
+    b += 16;
+  }
+  __m256 acc[6][2] = {{c00, c01}, {c10, c11}, {c20, c21},
+                      {c30, c31}, {c40, c41}, {c50, c51}};
+  __m256 va = _mm256_set1_ps(alpha);
+  __m256 vb = _mm256_set1_ps(beta);
+  for (int i = 0; i < 6; i++) {
+    float* out = c + i * ldc;
+    for (int h = 0; h < 2; h++) {
+      __m256 r = _mm256_mul_ps(va, acc[i][h]);
+      if (beta != 0) {
+        r = _mm256_fmadd_ps(vb, _mm256_loadu_ps(out + 8 * h), r);
+      }
+      _mm256_storeu_ps(out + 8 * h, r);
+    }
+  }
+}
+#endif
+
+template <typename T>
+const KernelInfo<T>& SelectKernel() {
+  static const KernelInfo<T> info = [] {
+    // Register tile width: two vectors per row in every kernel
+    constexpr int kLanes = 16 / sizeof(T);
+#ifdef S21_GEMM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      return KernelInfo<T>{KernelAvx2, 6, 4 * kLanes, "avx2"};
+    }
+    return KernelInfo<T>{KernelSse2, 4, 2 * kLanes, "sse2"};
+#else
+    (void)kLanes;
+    return KernelInfo<T>{KernelGeneric<T>, 4, 4, "generic"};
+#endif
+  }();
+  return info;
+}
+
+// Copies an mc x kc block of A into row panels of height mr, column by
+// column, zero-padding the last panel. Elements are converted to the
+// accumulation type on the way.
+template <typename In, typename T>
+void PackA(int mc, int kc, const In* a, int rsa, int csa, int mr, T* buffer) {
+  for (int ir = 0; ir < mc; ir += mr) {
+    int rows = std::min(mr, mc - ir);
+    for (int p = 0; p < kc; p++) {
+      const In* source = a + static_cast<long>(ir) * rsa +
+                         static_cast<long>(p) * csa;
+      for (int i = 0; i < rows; i++) {
+        buffer[i] = source[static_cast<long>(i) * rsa];
+      }
+      for (int i = rows; i < mr; i++) {
+        buffer[i] = 0;
+      }
+      buffer += mr;
+    }
+  }
+}
+
+// Copies a kc x nc block of B into column panels of width nr, row by row
+template <typename In, typename T>
+void PackB(int kc, int nc, const In* b, int rsb, int csb, int nr, T* buffer) {
+  for (int jr = 0; jr < nc; jr += nr) {
+    int cols = std::min(nr, nc - jr);
+    for (int p = 0; p < kc; p++) {
+      const In* source = b + static_cast<long>(p) * rsb +
+                         static_cast<long>(jr) * csb;
+      for (int j = 0; j < cols; j++) {
+        buffer[j] = source[static_cast<long>(j) * csb];
+      }
+      for (int j = cols; j < nr; j++) {
+        buffer[j] = 0;
+      }
+      buffer += nr;
+    }
+  }
+}
+
+template <typename In, typename T>
+void GemmSmall(int m, int n, int k, T alpha, const In* a, int rsa, int csa,
+               const In* b, int rsb, int csb, T beta, T* c, int ldc) {
+  for (int i = 0; i < m; i++) {
+    T* row_c = c + static_cast<long>(i) * ldc;
+    for (int j = 0; j < n; j++) {
+      row_c[j] = (beta == 0) ? 0 : beta * row_c[j];
+    }
+    for (int p = 0; p < k; p++) {
+      T value = alpha * static_cast<T>(a[static_cast<long>(i) * rsa +
+                                         static_cast<long>(p) * csa]);
+      const In* row_b = b + static_cast<long>(p) * rsb;
+      for (int j = 0; j < n; j++) {
+        row_c[j] += value * static_cast<T>(row_b[static_cast<long>(j) * csb]);
+      }
+    }
+  }
+}
+
+template <typename In, typename T>
+void GemmSerial(int m, int n, int k, T alpha, const In* a, int rsa, int csa,
+                const In* b, int rsb, int csb, T beta, T* c, int ldc) {
+  if (static_cast<long>(m) * n * k <= kSmallProduct) {
+    GemmSmall(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, ldc);
+    return;
+  }
+  const KernelInfo<T>& info = SelectKernel<T>();
+  int mr = info.mr;
+  int nr = info.nr;
+  // Panel width in whole nr column strips, padding included
+  int block_n = (kPackBytes / (sizeof(T) * kBlockK) / nr - 1) * nr;
+  thread_local std::vector<T> buffer_a;
+  thread_local std::vector<T> buffer_b;
+  buffer_a.resize(static_cast<size_t>(kBlockM + mr) * kBlockK);
+  buffer_b.resize(static_cast<size_t>(std::min(n, block_n) + nr) * kBlockK);
+  T tile[kMaxTile];
+  for (int jc = 0; jc < n; jc += block_n) {
+    int nc = std::min(block_n, n - jc);
+    for (int pc = 0; pc < k; pc += kBlockK) {
+      int kc = std::min(kBlockK, k - pc);
+      T block_beta = (pc == 0) ? beta : 1;
+      PackB(kc, nc,
+            b + static_cast<long>(pc) * rsb + static_cast<long>(jc) * csb,
+            rsb, csb, nr, buffer_b.data());
+      for (int ic = 0; ic < m; ic += kBlockM) {
+        int mc = std::min(kBlockM, m - ic);
+        PackA(mc, kc,
+              a + static_cast<long>(ic) * rsa + static_cast<long>(pc) * csa,
+              rsa, csa, mr, buffer_a.data());
+        for (int jr = 0; jr < nc; jr += nr) {
+          int cols = std::min(nr, nc - jr);
+          const T* panel_b = buffer_b.data() + static_cast<long>(jr) * kc;
+          for (int ir = 0; ir < mc; ir += mr) {
+            int rows = std::min(mr, mc - ir);
+            const T* panel_a = buffer_a.data() + static_cast<long>(ir) * kc;
+            T* out = c + static_cast<long>(ic + ir) * ldc + jc + jr;
+            if (rows == mr && cols == nr) {
+              info.kernel(kc, panel_a, panel_b, out, ldc, alpha, block_beta);
+            } else {
+              info.kernel(kc, panel_a, panel_b, tile, nr, 1, 0);
+              for (int i = 0; i < rows; i++) {
+                for (int j = 0; j < cols; j++) {
+                  T* value = out + static_cast<long>(i) * ldc + j;
+                  *value = alpha * tile[i * nr + j] +
+                           (block_beta == 0 ? 0 : block_beta * *value);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename In, typename T>
+void GemmParallel(int m, int n, int k, T alpha, const In* a, int rsa, int csa,
+                  const In* b, int rsb, int csb, T beta, T* c, int ldc) {
+  if (m <= 0 || n <= 0) {
+    return;
+  }
+  long work = static_cast<long>(m) * n * k;
+  int threads = GetNumThreads();
+  if (threads == 1 || work <= GetParallelThreshold()) {
+    GemmSerial(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, ldc);
+    return;
+  }
+  // 2D partition of C into about two tiles per thread, shaped after C
+  int tasks = 2 * threads;
+  int tiles_m =
+      static_cast<int>(lround(sqrt(static_cast<double>(tasks) * m / n)));
+  tiles_m = std::max(1, std::min(tiles_m, (m + kMinTile - 1) / kMinTile));
+  int tiles_n = std::max(1, std::min((tasks + tiles_m - 1) / tiles_m,
+                                     (n + kMinTile - 1) / kMinTile));
+  int tile_m = (m + tiles_m - 1) / tiles_m;
+  int tile_n = (n + tiles_n - 1) / tiles_n;
+  ThreadPool::Instance().ParallelFor(
+      0, static_cast<long>(tiles_m) * tiles_n, 1, [&](long lo, long hi) {
+        for (long tile = lo; tile < hi; tile++) {
+          int i = static_cast<int>(tile / tiles_n) * tile_m;
+          int j = static_cast<int>(tile % tiles_n) * tile_n;
+          GemmSerial(std::min(tile_m, m - i), std::min(tile_n, n - j), k,
+                     alpha, a + static_cast<long>(i) * rsa, rsa, csa,
+                     b + static_cast<long>(j) * csb, rsb, csb, beta,
+                     c + static_cast<long>(i) * ldc + j, ldc);
+        }
+      });
+}
+
+}  // namespace
+
+void Gemm(int m, int n, int k, double alpha, const double* a, int rsa,
+          int csa, const double* b, int rsb, int csb, double beta, double* c,
+          int ldc) {
+  GemmParallel(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, ldc);
+}
+
+void Gemm(int m, int n, int k, float alpha, const float* a, int rsa, int csa,
+          const float* b, int rsb, int csb, float beta, float* c, int ldc) {
+  GemmParallel(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, ldc);
+}
+
+void Gemm(int m, int n, int k, double alpha, const float* a, int rsa,
+          int csa, const float* b, int rsb, int csb, double beta, double* c,
+          int ldc) {
+  GemmParallel(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, ldc);
+}
+
+const char* GemmKernelName() { return SelectKernel<double>().name; }
+
+}  // namespace s21
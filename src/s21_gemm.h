@@ -0,0 +1,42 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_GEMM_H_
+#define S21_GEMM_H_
+
+namespace s21 {
+
+// C = alpha * A * B + beta * C for an m x k matrix A and a k x n matrix B.
+// A and B are addressed through a row stride and a column stride, so a
+// transposed operand is the same data with the strides swapped. C is row
+// major with leading dimension ldc.
+void Gemm(int m, int n, int k, double alpha, const double* a, int rsa,
+          int csa, const double* b, int rsb, int csb, double beta, double* c,
+          int ldc);
+void Gemm(int m, int n, int k, float alpha, const float* a, int rsa, int csa,
+          const float* b, int rsb, int csb, float beta, float* c, int ldc);
+
+// Mixed precision: single precision operands are widened while packed, so
+// every multiply-add is carried out and accumulated in double precision
+void Gemm(int m, int n, int k, double alpha, const float* a, int rsa,
+          int csa, const float* b, int rsb, int csb, double beta, double* c,
+          int ldc);
+
+// Name of the micro-kernel picked for this CPU ("avx2", "sse2", "generic")
+const char* GemmKernelName();
+
+}  // namespace s21
+
+#endif  // S21_GEMM_H_
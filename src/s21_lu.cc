@@ -0,0 +1,201 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_lu.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include "s21_thread_pool.h"
+
+// Constructors
+template <typename T>
+S21BasicLU<T>::S21BasicLU(S21BasicMatrix<T> A)
+    : lu_(std::move(A)), pivots_(lu_.rows_), sign_(1), singular_(false) {
+  if (lu_.cols_ != lu_.rows_) {
+    throw std::invalid_argument("The matrix is not square");
+  }
+  S21_PROFILE(s21::Operation::kLU, lu_.rows_, lu_.cols_,
+              2.0 / 3 * lu_.rows_ * lu_.Size(), 2.0 * sizeof(T) * lu_.Size());
+  Factorize();
+}
+
+// Accessors
+template <typename T>
+int S21BasicLU<T>::GetSize() const { return lu_.rows_; }
+
+template <typename T>
+const S21BasicMatrix<T>& S21BasicLU<T>::GetFactors() const { return lu_; }
+
+template <typename T>
+const std::vector<int>& S21BasicLU<T>::GetPivots() const { return pivots_; }
+
+// Algebra
+template <typename T>
+bool S21BasicLU<T>::IsSingular() const { return singular_; }
+
+template <typename T>
+T S21BasicLU<T>::Determinant() const {
+  if (singular_) {
+    return 0;
+  }
+  T result = sign_;
+  for (int i = 0; i < lu_.rows_; i++) {
+    result *= lu_.Row(i)[i];
+  }
+  return result;
+}
+
+template <typename T>
+S21BasicMatrix<T> S21BasicLU<T>::Inverse() const {
+  if (singular_) {
+    throw std::invalid_argument("Matrix determinant is 0");
+  }
+  int n = lu_.rows_;
+  S21BasicMatrix<T> result(n, n);
+  std::vector<int> order = RowOrder();
+  for (int i = 0; i < n; i++) {
+    result.Row(i)[order[i]] = 1;
+  }
+  Substitute(&result);
+  return result;
+}
+
+template <typename T>
+S21BasicMatrix<T> S21BasicLU<T>::Solve(const S21BasicMatrix<T>& b) const {
+  if (b.rows_ != lu_.rows_) {
+    throw std::invalid_argument("Different matrix dimensions");
+  }
+  if (singular_) {
+    throw std::invalid_argument("Matrix determinant is 0");
+  }
+  S21_PROFILE(s21::Operation::kSolve, b.rows_, b.cols_,
+              2.0 * lu_.Size() * b.cols_,
+              sizeof(T) * (lu_.Size() + 2.0 * b.Size()));
+  S21BasicMatrix<T> result(b.rows_, b.cols_);
+  std::vector<int> order = RowOrder();
+  for (int i = 0; i < b.rows_; i++) {
+    std::copy(b.Row(order[i]), b.Row(order[i]) + b.cols_, result.Row(i));
+  }
+  Substitute(&result);
+  return result;
+}
+
+// Extra functions
+template <typename T>
+std::vector<int> S21BasicLU<T>::RowOrder() const {
+  std::vector<int> order(lu_.rows_);
+  std::iota(order.begin(), order.end(), 0);
+  for (int k = 0; k < lu_.rows_; k++) {
+    std::swap(order[k], order[pivots_[k]]);
+  }
+  return order;
+}
+
+// Columns are independent right-hand sides: threads take bands of them
+// and every update below is a contiguous row operation
+template <typename T>
+void S21BasicLU<T>::Substitute(S21BasicMatrix<T>* b) const {
+  int n = lu_.rows_;
+  S21BasicMatrix<T>& result = *b;
+  long work = static_cast<long>(n) * n * result.cols_;
+  s21::ParallelFor(0, result.cols_, work, [&](long lo, long hi) {
+    for (int i = 1; i < n; i++) {
+      T* row_i = result.Row(i);
+      for (int k = 0; k < i; k++) {
+        T factor = lu_.Row(i)[k];
+        const T* row_k = result.Row(k);
+        for (long j = lo; j < hi; j++) {
+          row_i[j] -= factor * row_k[j];
+        }
+      }
+    }
+    for (int i = n - 1; i >= 0; i--) {
+      T* row_i = result.Row(i);
+      for (int k = i + 1; k < n; k++) {
+        T factor = lu_.Row(i)[k];
+        const T* row_k = result.Row(k);
+        for (long j = lo; j < hi; j++) {
+          row_i[j] -= factor * row_k[j];
+        }
+      }
+      T diagonal = lu_.Row(i)[i];
+      for (long j = lo; j < hi; j++) {
+        row_i[j] /= diagonal;
+      }
+    }
+  });
+}
+
+template <typename T>
+void S21BasicLU<T>::Factorize() {
+  int n = lu_.rows_;
+  // A pivot is rounding noise of an exactly singular input when it is
+  // below n * eps times both the largest element of its original row and
+  // that of its column. Scaling a row or a column therefore scales the
+  // tolerance with it, and a badly scaled nonsingular matrix keeps its
+  // pivots. Elimination goes on through noise pivots; only an exact zero,
+  // whose column is already eliminated, is skipped.
+  std::vector<T> row_scale(n);
+  std::vector<T> column_scale(n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      T value = fabs(lu_.Row(i)[j]);
+      row_scale[i] = fmax(row_scale[i], value);
+      column_scale[j] = fmax(column_scale[j], value);
+    }
+  }
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  for (int k = 0; k < n; k++) {
+    int pivot = k;
+    for (int i = k + 1; i < n; i++) {
+      if (fabs(lu_.Row(i)[k]) > fabs(lu_.Row(pivot)[k])) {
+        pivot = i;
+      }
+    }
+    pivots_[k] = pivot;
+    if (pivot != k) {
+      std::swap_ranges(lu_.Row(k), lu_.Row(k) + n, lu_.Row(pivot));
+      std::swap(order[k], order[pivot]);
+      sign_ = -sign_;
+    }
+    T diagonal = lu_.Row(k)[k];
+    T tolerance = n * S21ScalarTraits<T>::kEpsilon *
+                  std::min(row_scale[order[k]], column_scale[k]);
+    if (fabs(diagonal) <= tolerance) {
+      singular_ = true;
+    }
+    if (diagonal == 0) {
+      continue;
+    }
+    const T* row_k = lu_.Row(k);
+    long trailing = static_cast<long>(n - k) * (n - k);
+    s21::ParallelFor(k + 1, n, trailing, [&](long lo, long hi) {
+      for (long i = lo; i < hi; i++) {
+        T* row_i = lu_.Row(i);
+        T factor = row_i[k] / diagonal;
+        row_i[k] = factor;
+        for (int j = k + 1; j < n; j++) {
+          row_i[j] -= factor * row_k[j];
+        }
+      }
+    });
+  }
+}
+
+template class S21BasicLU<float>;
+template class S21BasicLU<double>;
@@ -0,0 +1,69 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_LU_H_
+#define S21_LU_H_
+
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+// LU factorization with partial pivoting: P * A = L * U.
+// L (unit diagonal, not stored) and U are packed into one square matrix,
+// the row permutation is kept as a list of row swaps.
+template <typename T>
+class S21BasicLU {
+ public:
+  // Constructors
+  // Takes the matrix by value: a view or an expression is evaluated
+  // straight into the storage that is factorized in place
+  explicit S21BasicLU(S21BasicMatrix<T> A);
+
+  // Accessors
+  int GetSize() const;
+  const S21BasicMatrix<T>& GetFactors() const;
+  const std::vector<int>& GetPivots() const;
+
+  // Algebra
+  // True when a pivot is rounding noise (see Factorize()): Determinant()
+  // is then exactly 0, Inverse() and Solve() throw
+  bool IsSingular() const;
+  T Determinant() const;
+  // A^-1 by forward and back substitution on the columns of P * I
+  S21BasicMatrix<T> Inverse() const;
+  // X with A * X = B, one column of X per column of B. The factorization
+  // is reused, so many solves with the same A cost O(n^2) each.
+  S21BasicMatrix<T> Solve(const S21BasicMatrix<T>& b) const;
+
+ private:
+  S21BasicMatrix<T> lu_;
+  std::vector<int> pivots_;
+  int sign_;
+  bool singular_;
+
+  // Extra functions
+  void Factorize();
+  // Row i of P * A is row order[i] of A
+  std::vector<int> RowOrder() const;
+  // Overwrites P * B with A^-1 * B
+  void Substitute(S21BasicMatrix<T>* b) const;
+};
+
+using S21LU = S21BasicLU<double>;
+using S21LUF = S21BasicLU<float>;
+
+extern template class S21BasicLU<float>;
+extern template class S21BasicLU<double>;
+#endif  // S21_LU_H_
@@ -0,0 +1,527 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_matrix_batch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "s21_thread_pool.h"
+
+namespace {
+
+#if defined(__x86_64__) || defined(__i386__)
+#define S21_BATCH_X86
+#endif
+
+// Outcome of inverting one chunk, first failing lane first
+enum class ChunkStatus { kInverted, kSingular, kIllConditioned };
+
+// Inverts the kLanes interleaved n x n matrices at values in place, with
+// the pivot and condition tests of S21Matrix::InverseMatrix applied to
+// the first lanes of them. scratch holds 2 * n * kLanes ints, row
+// n * kLanes elements.
+template <typename T, int kLanes>
+__attribute__((always_inline)) inline ChunkStatus InvertChunk(T* values,
+                                                              int n,
+                                                              int lanes,
+                                                              int* scratch,
+                                                              T* row) {
+  auto a = [&](int i, int j) {
+    return values + (static_cast<long>(i) * n + j) * kLanes;
+  };
+  // Largest column sum, the 1-norm, of each matrix
+  auto norm_one = [&](T* norm) {
+    for (int l = 0; l < kLanes; l++) {
+      norm[l] = 0;
+    }
+    for (int j = 0; j < n; j++) {
+      T sum[kLanes] = {};
+      for (int i = 0; i < n; i++) {
+        for (int l = 0; l < kLanes; l++) {
+          sum[l] += fabs(a(i, j)[l]);
+        }
+      }
+      for (int l = 0; l < kLanes; l++) {
+        norm[l] = std::max(norm[l], sum[l]);
+      }
+    }
+  };
+  T norm[kLanes];
+  norm_one(norm);
+  T tolerance[kLanes];
+  for (int l = 0; l < kLanes; l++) {
+    tolerance[l] = n * S21ScalarTraits<T>::kEpsilon * norm[l];
+  }
+  int* pivots = scratch;
+  for (int k = 0; k < n; k++) {
+    int* pivot = pivots + static_cast<long>(k) * kLanes;
+    T best[kLanes];
+    for (int l = 0; l < kLanes; l++) {
+      pivot[l] = k;
+      best[l] = fabs(a(k, k)[l]);
+    }
+    for (int i = k + 1; i < n; i++) {
+      const T* column = a(i, k);
+      for (int l = 0; l < kLanes; l++) {
+        bool larger = fabs(column[l]) > best[l];
+        pivot[l] = larger ? i : pivot[l];
+        best[l] = larger ? fabs(column[l]) : best[l];
+      }
+    }
+    for (int l = 0; l < lanes; l++) {
+      if (best[l] <= tolerance[l]) {
+        return ChunkStatus::kSingular;
+      }
+    }
+    // Row k trades places with each lane's pivot row in one pass over
+    // the row, with no branch per lane: where the pivot is k an element
+    // is swapped with itself
+    long offset[kLanes];
+    for (int l = 0; l < kLanes; l++) {
+      offset[l] = static_cast<long>(pivot[l] - k) * n * kLanes + l;
+    }
+    T* row_k = a(k, 0);
+    for (int j = 0; j < n; j++) {
+      T* lanes_k = row_k + static_cast<long>(j) * kLanes;
+      for (int l = 0; l < kLanes; l++) {
+        T other = lanes_k[offset[l]];
+        lanes_k[offset[l]] = lanes_k[l];
+        lanes_k[l] = other;
+      }
+    }
+    // Row k becomes row k of the inverse in place: its pivot column
+    // stores the scaled unit vector, as in S21Matrix::InverseMatrix
+    T inverse[kLanes];
+    T* diagonal = a(k, k);
+    for (int l = 0; l < kLanes; l++) {
+      inverse[l] = diagonal[l] != 0 ? 1 / diagonal[l] : 0;
+      diagonal[l] = 1;
+    }
+    for (int j = 0; j < n; j++) {
+      T* lanes_k = a(k, j);
+      for (int l = 0; l < kLanes; l++) {
+        lanes_k[l] *= inverse[l];
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      if (i == k) continue;
+      T factor[kLanes];
+      T* column = a(i, k);
+      for (int l = 0; l < kLanes; l++) {
+        factor[l] = column[l];
+        column[l] = 0;
+      }
+      for (int j = 0; j < n; j++) {
+        T* target = a(i, j);
+        const T* source = a(k, j);
+        for (int l = 0; l < kLanes; l++) {
+          target[l] -= factor[l] * source[l];
+        }
+      }
+    }
+  }
+  // The row swaps are undone as column swaps, last first. They are
+  // composed into one column order per lane and applied row by row.
+  int* source = scratch + static_cast<long>(n) * kLanes;
+  for (int j = 0; j < n; j++) {
+    for (int l = 0; l < kLanes; l++) {
+      source[j * kLanes + l] = j;
+    }
+  }
+  for (int k = n - 1; k >= 0; k--) {
+    const int* pivot = pivots + static_cast<long>(k) * kLanes;
+    for (int l = 0; l < kLanes; l++) {
+      std::swap(source[k * kLanes + l], source[pivot[l] * kLanes + l]);
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    T* lanes_i = a(i, 0);
+    std::copy(lanes_i, lanes_i + static_cast<long>(n) * kLanes, row);
+    for (int j = 0; j < n; j++) {
+      for (int l = 0; l < kLanes; l++) {
+        lanes_i[j * kLanes + l] = row[source[j * kLanes + l] * kLanes + l];
+      }
+    }
+  }
+  // Reciprocal condition number estimate 1 / (|A|_1 * |A^-1|_1)
+  T inverse_norm[kLanes];
+  norm_one(inverse_norm);
+  for (int l = 0; l < lanes; l++) {
+    if (1 / (norm[l] * inverse_norm[l]) < n * S21ScalarTraits<T>::kEpsilon) {
+      return ChunkStatus::kIllConditioned;
+    }
+  }
+  return ChunkStatus::kInverted;
+}
+
+template <typename T>
+using ChunkInverter = ChunkStatus (*)(T* values, int n, int lanes,
+                                      int* scratch, T* row);
+
+template <typename T, int kLanes>
+ChunkStatus InvertChunkGeneric(T* values, int n, int lanes, int* scratch,
+                        T* row) {
+  return InvertChunk<T, kLanes>(values, n, lanes, scratch, row);
+}
+
+#ifdef S21_BATCH_X86
+// The same steps with 256-bit vectors and fused multiply-adds
+template <typename T, int kLanes>
+__attribute__((target("avx2,fma"))) ChunkStatus InvertChunkAvx2(
+    T* values, int n, int lanes, int* scratch, T* row) {
+  return InvertChunk<T, kLanes>(values, n, lanes, scratch, row);
+}
+#endif
+
+template <typename T, int kLanes>
+ChunkInverter<T> SelectInverter() {
+  static const ChunkInverter<T> inverter = []() -> ChunkInverter<T> {
+#ifdef S21_BATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      return InvertChunkAvx2<T, kLanes>;
+    }
+#endif
+    return InvertChunkGeneric<T, kLanes>;
+  }();
+  return inverter;
+}
+
+}  // namespace
+
+// Constructors
+template <typename T>
+S21BasicMatrixBatch<T>::S21BasicMatrixBatch(int count, int rows, int cols)
+    : count_(count), rows_(rows), cols_(cols) {
+  if (rows <= 0 || cols <= 0) {
+    throw std::invalid_argument("Rows and cols must be greater than 0");
+  }
+  if (count <= 0) {
+    throw std::invalid_argument("Batch size must be greater than 0");
+  }
+  values_.assign(static_cast<size_t>(Chunks()) * rows * cols * kChunk, 0);
+}
+
+// Mutators
+template <typename T>
+S21BasicMatrix<T> S21BasicMatrixBatch<T>::Get(int index) const {
+  CheckIndex(index, 0, 0);
+  S21BasicMatrix<T> result(rows_, cols_);
+  for (int i = 0; i < rows_; i++) {
+    for (int j = 0; j < cols_; j++) {
+      result(i, j) = Element(index, i, j);
+    }
+  }
+  return result;
+}
+
+template <typename T>
+void S21BasicMatrixBatch<T>::Set(int index, const S21BasicMatrix<T>& matrix) {
+  CheckIndex(index, 0, 0);
+  if (matrix.GetRows() != rows_ || matrix.GetCols() != cols_) {
+    throw std::invalid_argument("Different matrix dimensions");
+  }
+  for (int i = 0; i < rows_; i++) {
+    for (int j = 0; j < cols_; j++) {
+      Element(index, i, j) = matrix.At(i, j);
+    }
+  }
+}
+
+// Equals
+template <typename T>
+bool S21BasicMatrixBatch<T>::EqMatrix(const S21BasicMatrixBatch& other) const {
+  if (count_ != other.count_ || rows_ != other.rows_ ||
+      cols_ != other.cols_) {
+    return false;
+  }
+  // Padding matrices are zero on both sides
+  for (size_t i = 0; i < values_.size(); i++) {
+    if (fabs(values_[i] - other.values_[i]) > S21ScalarTraits<T>::kTolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Multiplication
+template <typename T>
+void S21BasicMatrixBatch<T>::MulNumber(const T num) {
+  for (T& value : values_) {
+    value *= num;
+  }
+}
+
+template <typename T>
+void S21BasicMatrixBatch<T>::MulMatrix(const S21BasicMatrixBatch& other) {
+  if (count_ != other.count_) {
+    throw std::invalid_argument("Different batch sizes");
+  }
+  S21BasicMatrix<T>::CheckProduct(cols_, other.rows_);
+  if (other.cols_ == cols_) {
+    // Same shape: each chunk is replaced in place, no new storage
+    Product(*this, other, this);
+  } else {
+    S21BasicMatrixBatch result(count_, rows_, other.cols_);
+    Product(*this, other, &result);
+    *this = std::move(result);
+  }
+}
+
+// result may be a, so every chunk of the product is formed in scratch
+// space before it is stored
+template <typename T>
+void S21BasicMatrixBatch<T>::Product(const S21BasicMatrixBatch& a,
+                                     const S21BasicMatrixBatch& b,
+                                     S21BasicMatrixBatch* result) {
+  int rows = a.rows_;
+  int cols = b.cols_;
+  int depth = a.cols_;
+  long work = a.values_.size() * static_cast<long>(cols);
+  s21::ParallelFor(0, a.Chunks(), work, [&](long lo, long hi) {
+    std::vector<T> scratch(static_cast<size_t>(rows) * cols * kChunk);
+    for (long chunk = lo; chunk < hi; chunk++) {
+      T* out = scratch.data();
+      for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++, out += kChunk) {
+          T sum[kChunk] = {};
+          for (int p = 0; p < depth; p++) {
+            const T* x = a.Lanes(chunk, i, p);
+            const T* y = b.Lanes(chunk, p, j);
+            for (int l = 0; l < kChunk; l++) {
+              sum[l] += x[l] * y[l];
+            }
+          }
+          std::copy(sum, sum + kChunk, out);
+        }
+      }
+      std::copy(scratch.begin(), scratch.end(), result->Lanes(chunk, 0, 0));
+    }
+  });
+}
+
+// Transpose
+template <typename T>
+S21BasicMatrixBatch<T> S21BasicMatrixBatch<T>::Transpose() const {
+  S21BasicMatrixBatch result(count_, cols_, rows_);
+  s21::ParallelFor(0, Chunks(), values_.size(), [&](long lo, long hi) {
+    for (long chunk = lo; chunk < hi; chunk++) {
+      for (int i = 0; i < rows_; i++) {
+        for (int j = 0; j < cols_; j++) {
+          memcpy(result.Lanes(chunk, j, i), Lanes(chunk, i, j),
+                 sizeof(T) * kChunk);
+        }
+      }
+    }
+  });
+  return result;
+}
+
+// Algebra
+template <typename T>
+void S21BasicMatrixBatch<T>::CheckSquare() const {
+  if (rows_ != cols_) {
+    throw std::invalid_argument("The matrix is not square");
+  }
+}
+
+// Gaussian elimination with partial pivoting on a copy of each chunk.
+// The pivot row differs between matrices, so only the row swap is done
+// matrix by matrix; a zero pivot zeroes that determinant and its
+// elimination factors, which keeps the other matrices going.
+template <typename T>
+std::vector<T> S21BasicMatrixBatch<T>::Determinant() const {
+  CheckSquare();
+  int n = rows_;
+  std::vector<T> result(Chunks() * kChunk);
+  long work = values_.size() * static_cast<long>(n);
+  s21::ParallelFor(0, Chunks(), work, [&](long lo, long hi) {
+    std::vector<T> scratch(static_cast<size_t>(n) * n * kChunk);
+    auto a = [&](int i, int j) {
+      return scratch.data() + (static_cast<long>(i) * n + j) * kChunk;
+    };
+    for (long chunk = lo; chunk < hi; chunk++) {
+      std::copy(Lanes(chunk, 0, 0), Lanes(chunk + 1, 0, 0), scratch.data());
+      T* det = result.data() + chunk * kChunk;
+      std::fill(det, det + kChunk, 1);
+      for (int k = 0; k < n; k++) {
+        int pivot[kChunk];
+        T best[kChunk];
+        for (int l = 0; l < kChunk; l++) {
+          pivot[l] = k;
+          best[l] = fabs(a(k, k)[l]);
+        }
+        for (int i = k + 1; i < n; i++) {
+          const T* column = a(i, k);
+          for (int l = 0; l < kChunk; l++) {
+            bool larger = fabs(column[l]) > best[l];
+            pivot[l] = larger ? i : pivot[l];
+            best[l] = larger ? fabs(column[l]) : best[l];
+          }
+        }
+        for (int l = 0; l < kChunk; l++) {
+          if (pivot[l] != k) {
+            det[l] = -det[l];
+            for (int j = k; j < n; j++) {
+              std::swap(a(k, j)[l], a(pivot[l], j)[l]);
+            }
+          }
+        }
+        T inverse[kChunk];
+        const T* diagonal = a(k, k);
+        for (int l = 0; l < kChunk; l++) {
+          det[l] *= diagonal[l];
+          inverse[l] = diagonal[l] != 0 ? 1 / diagonal[l] : 0;
+        }
+        for (int i = k + 1; i < n; i++) {
+          T factor[kChunk];
+          const T* below = a(i, k);
+          for (int l = 0; l < kChunk; l++) {
+            factor[l] = below[l] * inverse[l];
+          }
+          for (int j = k + 1; j < n; j++) {
+            T* target = a(i, j);
+            const T* source = a(k, j);
+            for (int l = 0; l < kChunk; l++) {
+              target[l] -= factor[l] * source[l];
+            }
+          }
+        }
+      }
+    }
+  });
+  result.resize(count_);
+  return result;
+}
+
+// Gauss-Jordan elimination with partial pivoting, chunk by chunk, on the
+// result itself, or matrix by matrix above kMaxChunkedInverse. Each
+// matrix passes the singularity and condition tests of
+// S21Matrix::InverseMatrix and fails them with the same exceptions.
+template <typename T>
+S21BasicMatrixBatch<T> S21BasicMatrixBatch<T>::InverseMatrix() const {
+  CheckSquare();
+  int n = rows_;
+  bool chunked = n <= kMaxChunkedInverse;
+  S21BasicMatrixBatch result =
+      chunked ? *this : S21BasicMatrixBatch(count_, n, n);
+  long work = values_.size() * static_cast<long>(n);
+  if (chunked) {
+    ChunkInverter<T> invert = SelectInverter<T, kChunk>();
+    s21::ParallelFor(0, Chunks(), work, [&](long lo, long hi) {
+      std::vector<int> scratch(static_cast<size_t>(n) * kChunk * 2);
+      std::vector<T> row(static_cast<size_t>(n) * kChunk);
+      for (long chunk = lo; chunk < hi; chunk++) {
+        int lanes = std::min<long>(kChunk, count_ - chunk * kChunk);
+        ChunkStatus status = invert(result.Lanes(chunk, 0, 0), n, lanes,
+                                    scratch.data(), row.data());
+        if (status == ChunkStatus::kSingular) {
+          throw std::invalid_argument("Matrix determinant is 0");
+        }
+        if (status == ChunkStatus::kIllConditioned) {
+          throw std::invalid_argument(
+              "Matrix is too ill-conditioned to invert");
+        }
+      }
+    });
+  } else {
+    // S21Matrix::InverseMatrix throws for a failing matrix
+    s21::ParallelFor(0, Chunks(), work, [&](long lo, long hi) {
+      std::vector<S21BasicMatrix<T>> matrices(kChunk, S21BasicMatrix<T>(n, n));
+      for (long chunk = lo; chunk < hi; chunk++) {
+        int lanes = std::min<long>(kChunk, count_ - chunk * kChunk);
+        for (int i = 0; i < n; i++) {
+          for (int j = 0; j < n; j++) {
+            const T* lanes_ij = Lanes(chunk, i, j);
+            for (int l = 0; l < lanes; l++) {
+              matrices[l].Row(i)[j] = lanes_ij[l];
+            }
+          }
+        }
+        for (int l = 0; l < lanes; l++) {
+          matrices[l] = matrices[l].InverseMatrix();
+        }
+        for (int i = 0; i < n; i++) {
+          for (int j = 0; j < n; j++) {
+            T* lanes_ij = result.Lanes(chunk, i, j);
+            for (int l = 0; l < lanes; l++) {
+              lanes_ij[l] = matrices[l].Row(i)[j];
+            }
+          }
+        }
+      }
+    });
+  }
+  return result;
+}
+
+// Overloaded
+template <typename T>
+T& S21BasicMatrixBatch<T>::operator()(int index, int row, int col) {
+  CheckIndex(index, row, col);
+  return Element(index, row, col);
+}
+
+template <typename T>
+T S21BasicMatrixBatch<T>::operator()(int index, int row, int col) const {
+  CheckIndex(index, row, col);
+  return Element(index, row, col);
+}
+
+template <typename T>
+bool S21BasicMatrixBatch<T>::operator==(
+    const S21BasicMatrixBatch& other) const {
+  return EqMatrix(other);
+}
+
+template <typename T>
+S21BasicMatrixBatch<T> S21BasicMatrixBatch<T>::operator*(
+    const S21BasicMatrixBatch& other) const {
+  if (count_ != other.count_) {
+    throw std::invalid_argument("Different batch sizes");
+  }
+  S21BasicMatrix<T>::CheckProduct(cols_, other.rows_);
+  S21BasicMatrixBatch result(count_, rows_, other.cols_);
+  Product(*this, other, &result);
+  return result;
+}
+
+template <typename T>
+S21BasicMatrixBatch<T>& S21BasicMatrixBatch<T>::operator*=(
+    const S21BasicMatrixBatch& other) {
+  MulMatrix(other);
+  return *this;
+}
+
+template <typename T>
+S21BasicMatrixBatch<T>& S21BasicMatrixBatch<T>::operator*=(const T num) {
+  MulNumber(num);
+  return *this;
+}
+
+// Extra functions
+template <typename T>
+void S21BasicMatrixBatch<T>::CheckIndex(int index, int row, int col) const {
+  if (index < 0 || index >= count_ || row < 0 || row >= rows_ || col < 0 ||
+      col >= cols_) {
+    throw std::out_of_range("Index is outside the matrix");
+  }
+}
+
+template class S21BasicMatrixBatch<float>;
+template class S21BasicMatrixBatch<double>;
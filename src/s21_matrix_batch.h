@@ -0,0 +1,109 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_MATRIX_BATCH_H_
+#define S21_MATRIX_BATCH_H_
+
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+// Many matrices of one shape stored interleaved in chunks of kChunk: inside
+// a chunk, element (row, col) of its matrices is one contiguous run. Each
+// operation runs the same scalar steps for a whole chunk at once, so the
+// innermost loops go across matrices, vectorize, and have no per-matrix
+// branches. A chunk is contiguous too, and chunks are spread over the
+// thread pool.
+template <typename T>
+class S21BasicMatrixBatch {
+ public:
+  using Scalar = T;
+
+  // Constructors
+  S21BasicMatrixBatch(int count, int rows, int cols);
+
+  // Mutators
+  int GetCount() const { return count_; }
+  int GetRows() const { return rows_; }
+  int GetCols() const { return cols_; }
+  S21BasicMatrix<T> Get(int index) const;
+  void Set(int index, const S21BasicMatrix<T>& matrix);
+
+  // Equals
+  bool EqMatrix(const S21BasicMatrixBatch& other) const;
+
+  // Multiplication
+  void MulNumber(const T num);
+  // Multiplies every matrix by the matrix with the same index in other
+  void MulMatrix(const S21BasicMatrixBatch& other);
+
+  // Transpose
+  S21BasicMatrixBatch Transpose() const;
+
+  // Algebra
+  std::vector<T> Determinant() const;
+  // Throws if any matrix of the batch is singular
+  S21BasicMatrixBatch InverseMatrix() const;
+
+  // Overloaded
+  T& operator()(int index, int row, int col);
+  T operator()(int index, int row, int col) const;
+  bool operator==(const S21BasicMatrixBatch& other) const;
+  S21BasicMatrixBatch operator*(const S21BasicMatrixBatch& other) const;
+  S21BasicMatrixBatch& operator*=(const S21BasicMatrixBatch& other);
+  S21BasicMatrixBatch& operator*=(const T num);
+
+ private:
+  // Matrices handled together by one pass of a kernel; the last chunk is
+  // padded with zero matrices
+  static constexpr int kChunk = 16;
+  // Largest order inverted chunk-wise: above it a chunk of matrices no
+  // longer fits the L1 cache and one matrix at a time is faster
+  static constexpr int kMaxChunkedInverse = 12;
+
+  int count_;
+  int rows_;
+  int cols_;
+  std::vector<T> values_;
+
+  // Extra functions
+  long Chunks() const { return (count_ + kChunk - 1) / kChunk; }
+  // Element (row, col) of the kChunk matrices of a chunk
+  T* Lanes(long chunk, int row, int col) {
+    return values_.data() + ((chunk * rows_ + row) * cols_ + col) * kChunk;
+  }
+  const T* Lanes(long chunk, int row, int col) const {
+    return values_.data() + ((chunk * rows_ + row) * cols_ + col) * kChunk;
+  }
+  T& Element(int index, int row, int col) {
+    return Lanes(index / kChunk, row, col)[index % kChunk];
+  }
+  T Element(int index, int row, int col) const {
+    return Lanes(index / kChunk, row, col)[index % kChunk];
+  }
+  static void Product(const S21BasicMatrixBatch& a,
+                      const S21BasicMatrixBatch& b,
+                      S21BasicMatrixBatch* result);
+  void CheckIndex(int index, int row, int col) const;
+  void CheckSquare() const;
+};
+
+using S21MatrixBatch = S21BasicMatrixBatch<double>;
+using S21MatrixBatchF = S21BasicMatrixBatch<float>;
+
+extern template class S21BasicMatrixBatch<float>;
+extern template class S21BasicMatrixBatch<double>;
+
+#endif  // S21_MATRIX_BATCH_H_
@@ -0,0 +1,186 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_MATRIX_EXPR_H_
+#define S21_MATRIX_EXPR_H_
+
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+// Element-wise arithmetic is lazy: A + B * 2.0 - C builds a tree of light
+// nodes and the whole tree is evaluated in one pass when it is assigned to
+// an S21Matrix. Nodes reference their matrix operands, so an expression
+// must be evaluated before those matrices go away (do not keep it in auto).
+
+template <typename T>
+class S21BasicMatrix;
+
+// Where a leaf of an expression keeps its elements: element (row, col) is
+// data[row * row_stride + col * col_stride]. Strides are never negative.
+template <typename T>
+struct S21MatrixLayout {
+  const T* data;
+  int rows;
+  int cols;
+  int row_stride;
+  int col_stride;
+
+  const T* End() const {
+    return data + static_cast<long>(rows - 1) * row_stride +
+           static_cast<long>(cols - 1) * col_stride + 1;
+  }
+
+  // True when writing `target` element by element could overwrite one of
+  // these elements before it is read. Reading the very element that is
+  // being written is safe.
+  bool Conflicts(const S21MatrixLayout& target) const {
+    bool same = data == target.data && row_stride == target.row_stride &&
+                col_stride == target.col_stride;
+    return !same && data < target.End() && target.data < End();
+  }
+};
+
+// CRTP base of everything that can appear in an element-wise expression.
+// E provides Scalar, GetRows(), GetCols(), At(row, col) and
+// Aliases(target), which tells whether the expression can be evaluated
+// straight into the memory described by target.
+template <typename E>
+class S21MatrixExpr {
+ public:
+  const E& Self() const { return static_cast<const E&>(*this); }
+};
+
+// Leaves that expose a Layout(): products hand them to GEMM as they are
+template <typename E>
+struct S21IsStridedExpr : std::false_type {};
+
+// Matrices are held by reference, intermediate nodes by value
+template <typename E>
+struct S21MatrixExprOperand {
+  using Type = const E;
+};
+
+template <typename T>
+struct S21MatrixExprOperand<S21BasicMatrix<T>> {
+  using Type = const S21BasicMatrix<T>&;
+};
+
+template <typename T>
+struct S21IsStridedExpr<S21BasicMatrix<T>> : std::true_type {};
+
+template <typename L, typename R, typename Op>
+class S21MatrixBinaryExpr
+    : public S21MatrixExpr<S21MatrixBinaryExpr<L, R, Op>> {
+ public:
+  using Scalar = typename L::Scalar;
+  static_assert(std::is_same<Scalar, typename R::Scalar>::value,
+                "Operands have different element types");
+
+  S21MatrixBinaryExpr(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+    if (lhs.GetRows() != rhs.GetRows() || lhs.GetCols() != rhs.GetCols()) {
+      throw std::invalid_argument("Different matrix dimensions");
+    }
+  }
+
+  int GetRows() const { return lhs_.GetRows(); }
+  int GetCols() const { return lhs_.GetCols(); }
+  Scalar At(long row, int col) const {
+    return Op()(lhs_.At(row, col), rhs_.At(row, col));
+  }
+  bool Aliases(const S21MatrixLayout<Scalar>& target) const {
+    return lhs_.Aliases(target) || rhs_.Aliases(target);
+  }
+
+ private:
+  typename S21MatrixExprOperand<L>::Type lhs_;
+  typename S21MatrixExprOperand<R>::Type rhs_;
+};
+
+template <typename E>
+class S21MatrixScaledExpr : public S21MatrixExpr<S21MatrixScaledExpr<E>> {
+ public:
+  using Scalar = typename E::Scalar;
+
+  S21MatrixScaledExpr(const E& expr, Scalar num) : expr_(expr), num_(num) {}
+
+  int GetRows() const { return expr_.GetRows(); }
+  int GetCols() const { return expr_.GetCols(); }
+  Scalar At(long row, int col) const { return expr_.At(row, col) * num_; }
+  bool Aliases(const S21MatrixLayout<Scalar>& target) const {
+    return expr_.Aliases(target);
+  }
+
+ private:
+  typename S21MatrixExprOperand<E>::Type expr_;
+  Scalar num_;
+};
+
+// Transpose of a matrix that moves no elements. Element-wise nodes read it
+// with swapped indices; products hand it to GEMM as swapped strides.
+template <typename T>
+class S21TransposedView : public S21MatrixExpr<S21TransposedView<T>> {
+ public:
+  using Scalar = T;
+
+  explicit S21TransposedView(const S21BasicMatrix<T>& matrix)
+      : matrix_(matrix) {}
+
+  int GetRows() const { return matrix_.GetCols(); }
+  int GetCols() const { return matrix_.GetRows(); }
+  Scalar At(long row, int col) const { return matrix_.At(col, row); }
+  const S21BasicMatrix<T>& GetMatrix() const { return matrix_; }
+  S21MatrixLayout<T> Layout() const {
+    S21MatrixLayout<T> layout = matrix_.Layout();
+    return {layout.data, layout.cols, layout.rows, layout.col_stride,
+            layout.row_stride};
+  }
+  bool Aliases(const S21MatrixLayout<T>& target) const {
+    return Layout().Conflicts(target);
+  }
+
+ private:
+  const S21BasicMatrix<T>& matrix_;
+};
+
+template <typename T>
+struct S21IsStridedExpr<S21TransposedView<T>> : std::true_type {};
+
+template <typename L, typename R>
+S21MatrixBinaryExpr<L, R, std::plus<>> operator+(
+    const S21MatrixExpr<L>& lhs, const S21MatrixExpr<R>& rhs) {
+  return S21MatrixBinaryExpr<L, R, std::plus<>>(lhs.Self(), rhs.Self());
+}
+
+template <typename L, typename R>
+S21MatrixBinaryExpr<L, R, std::minus<>> operator-(
+    const S21MatrixExpr<L>& lhs, const S21MatrixExpr<R>& rhs) {
+  return S21MatrixBinaryExpr<L, R, std::minus<>>(lhs.Self(),
+                                                       rhs.Self());
+}
+
+template <typename E>
+S21MatrixScaledExpr<E> operator*(const S21MatrixExpr<E>& expr,
+                                 const typename E::Scalar num) {
+  return S21MatrixScaledExpr<E>(expr.Self(), num);
+}
+
+template <typename E>
+S21MatrixScaledExpr<E> operator*(const typename E::Scalar num,
+                                 const S21MatrixExpr<E>& expr) {
+  return S21MatrixScaledExpr<E>(expr.Self(), num);
+}
+
+#endif  // S21_MATRIX_EXPR_H_
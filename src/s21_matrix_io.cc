@@ -0,0 +1,378 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_matrix_io.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include "s21_gemm.h"
+
+namespace {
+
+template <typename T>
+void CheckHeader(const S21MatrixFileHeader& header) {
+  if (memcmp(header.magic, S21MatrixFileHeader::kMagic,
+             sizeof(header.magic)) != 0) {
+    throw std::invalid_argument("Not a matrix file");
+  }
+  if (header.version != S21MatrixFileHeader::kVersion) {
+    throw std::invalid_argument("Unsupported matrix file version");
+  }
+  if (header.byte_order != S21MatrixFileHeader::kByteOrder) {
+    throw std::invalid_argument("Matrix file byte order differs");
+  }
+  if (header.scalar_size != sizeof(T)) {
+    throw std::invalid_argument("Matrix file element type differs");
+  }
+  if (header.rows <= 0 || header.cols <= 0 || header.stride < header.cols ||
+      header.payload_offset < sizeof(header)) {
+    throw std::invalid_argument("Corrupt matrix file header");
+  }
+}
+
+uint64_t PayloadSize(const S21MatrixFileHeader& header) {
+  return static_cast<uint64_t>(header.rows) * header.stride *
+         header.scalar_size;
+}
+
+// Descriptor that is closed when it goes out of scope
+struct File {
+  explicit File(int descriptor) : fd(descriptor) {}
+  File(const File&) = delete;
+  File& operator=(const File&) = delete;
+  ~File() {
+    if (fd >= 0) close(fd);
+  }
+  int fd;
+};
+
+void ReadFully(const File& file, void* buffer, size_t size, uint64_t offset) {
+  char* out = static_cast<char*>(buffer);
+  while (size > 0) {
+    ssize_t done = pread(file.fd, out, size, offset);
+    if (done < 0) throw std::runtime_error("Cannot read matrix file");
+    if (done == 0) throw std::invalid_argument("Matrix file is truncated");
+    out += done;
+    size -= done;
+    offset += done;
+  }
+}
+
+void WriteFully(const File& file, const void* buffer, size_t size,
+                uint64_t offset) {
+  const char* in = static_cast<const char*>(buffer);
+  while (size > 0) {
+    ssize_t done = pwrite(file.fd, in, size, offset);
+    if (done < 0) throw std::runtime_error("Cannot write matrix file");
+    in += done;
+    size -= done;
+    offset += done;
+  }
+}
+
+template <typename T>
+S21MatrixFileHeader ReadHeader(const File& file, const std::string& path) {
+  if (file.fd < 0) {
+    throw std::runtime_error("Cannot open " + path);
+  }
+  S21MatrixFileHeader header;
+  struct stat info;
+  if (fstat(file.fd, &info) != 0 ||
+      static_cast<size_t>(info.st_size) < sizeof(header)) {
+    throw std::invalid_argument("Not a matrix file");
+  }
+  ReadFully(file, &header, sizeof(header), 0);
+  CheckHeader<T>(header);
+  if (header.payload_offset + PayloadSize(header) >
+      static_cast<uint64_t>(info.st_size)) {
+    throw std::invalid_argument("Matrix file is truncated");
+  }
+  return header;
+}
+
+bool SameFile(const File& a, const File& b) {
+  struct stat a_info;
+  struct stat b_info;
+  return fstat(a.fd, &a_info) == 0 && fstat(b.fd, &b_info) == 0 &&
+         a_info.st_dev == b_info.st_dev && a_info.st_ino == b_info.st_ino;
+}
+
+// Copies a rows x cols block at (row, col) of a matrix file into a dense
+// row-major buffer, one read per row
+template <typename T>
+void ReadBlock(const File& file, const S21MatrixFileHeader& header, int row,
+               int col, int rows, int cols, T* block) {
+  for (int i = 0; i < rows; i++) {
+    uint64_t element = static_cast<uint64_t>(row + i) * header.stride + col;
+    ReadFully(file, block + static_cast<long>(i) * cols, sizeof(T) * cols,
+              header.payload_offset + element * sizeof(T));
+  }
+}
+
+template <typename T>
+void WriteBlock(const File& file, const S21MatrixFileHeader& header, int row,
+                int col, int rows, int cols, const T* block) {
+  for (int i = 0; i < rows; i++) {
+    uint64_t element = static_cast<uint64_t>(row + i) * header.stride + col;
+    WriteFully(file, block + static_cast<long>(i) * cols, sizeof(T) * cols,
+               header.payload_offset + element * sizeof(T));
+  }
+}
+
+}  // namespace
+
+// Files
+template <typename T>
+void S21BasicMatrix<T>::Save(const std::string& path) const {
+  static_assert(sizeof(S21MatrixFileHeader) % kAlignment == 0,
+                "The payload must start on a row boundary");
+  S21_PROFILE(s21::Operation::kSave, rows_, cols_, 0,
+              sizeof(T) * rows_ * stride_);
+  S21MatrixFileHeader header = {};
+  memcpy(header.magic, S21MatrixFileHeader::kMagic, sizeof(header.magic));
+  header.version = S21MatrixFileHeader::kVersion;
+  header.byte_order = S21MatrixFileHeader::kByteOrder;
+  header.scalar_size = sizeof(T);
+  header.alignment = kAlignment;
+  header.rows = rows_;
+  header.cols = cols_;
+  header.stride = stride_;
+  header.payload_offset = sizeof(header);
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("Cannot open " + path);
+  }
+  // Padding is kept zero, so the whole buffer goes out in one write
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(matrix_),
+             sizeof(T) * rows_ * stride_);
+  if (!file) {
+    throw std::runtime_error("Cannot write " + path);
+  }
+}
+
+template <typename T>
+S21BasicMatrix<T> S21BasicMatrix<T>::Load(const std::string& path) {
+  // The header is checked against the file size before the matrix is
+  // allocated, so a corrupt header cannot ask for rows x stride elements
+  File file(open(path.c_str(), O_RDONLY));
+  S21MatrixFileHeader header = ReadHeader<T>(file, path);
+  S21_PROFILE(s21::Operation::kLoad, header.rows, header.cols, 0,
+              PayloadSize(header));
+  S21BasicMatrix result(header.rows, header.cols);
+  if (header.stride == result.stride_) {
+    ReadFully(file, result.matrix_, sizeof(T) * result.rows_ * result.stride_,
+              header.payload_offset);
+    // Another writer may have left garbage in the padding
+    for (int i = 0; i < result.rows_; i++) {
+      std::fill(result.Row(i) + result.cols_, result.Row(i) + result.stride_,
+                T());
+    }
+  } else {
+    // Written with another row alignment: copy row by row
+    for (int i = 0; i < result.rows_; i++) {
+      ReadBlock(file, header, i, 0, 1, result.cols_, result.Row(i));
+    }
+  }
+  return result;
+}
+
+template <typename T>
+S21BasicMappedMatrix<T> S21BasicMatrix<T>::MapFile(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open " + path);
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+      static_cast<size_t>(info.st_size) < sizeof(S21MatrixFileHeader)) {
+    close(fd);
+    throw std::invalid_argument("Not a matrix file");
+  }
+  size_t size = info.st_size;
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Cannot map " + path);
+  }
+  const S21MatrixFileHeader& header =
+      *static_cast<const S21MatrixFileHeader*>(mapping);
+  try {
+    CheckHeader<T>(header);
+    if (header.payload_offset + PayloadSize(header) > size) {
+      throw std::invalid_argument("Matrix file is truncated");
+    }
+  } catch (...) {
+    munmap(mapping, size);
+    throw;
+  }
+  // Pages are read later, on access
+  S21_PROFILE(s21::Operation::kMapFile, header.rows, header.cols, 0, 0);
+  return S21BasicMappedMatrix<T>(mapping, size, header);
+}
+
+template <typename T>
+void S21BasicMatrix<T>::MulFiles(const std::string& a_path,
+                                 const std::string& b_path,
+                                 const std::string& result_path,
+                                 size_t memory_budget) {
+  File a_file(open(a_path.c_str(), O_RDONLY));
+  S21MatrixFileHeader a = ReadHeader<T>(a_file, a_path);
+  File b_file(open(b_path.c_str(), O_RDONLY));
+  S21MatrixFileHeader b = ReadHeader<T>(b_file, b_path);
+  CheckProduct(a.cols, b.rows);
+  int m = a.rows;
+  int n = b.cols;
+  int k = a.cols;
+  S21_PROFILE(s21::Operation::kMulFiles, m, k, 2.0 * m * k * n,
+              static_cast<double>(PayloadSize(a)) + PayloadSize(b) +
+                  sizeof(T) * static_cast<double>(m) * Stride(n));
+  // Two A tiles and two B tiles (one being read, one being multiplied)
+  // plus the C tile: five square tiles fill the budget
+  int tile = static_cast<int>(std::sqrt(memory_budget / (5.0 * sizeof(T))));
+  if (tile < 1) {
+    throw std::invalid_argument("Memory budget is too small");
+  }
+  File result_file(open(result_path.c_str(), O_RDWR | O_CREAT, 0644));
+  if (result_file.fd < 0) {
+    throw std::runtime_error("Cannot open " + result_path);
+  }
+  if (SameFile(result_file, a_file) || SameFile(result_file, b_file)) {
+    throw std::invalid_argument("The result file must not be an operand");
+  }
+  S21MatrixFileHeader c = a;
+  c.cols = n;
+  c.stride = Stride(n);
+  c.payload_offset = sizeof(c);
+  // Truncating first keeps the row padding zero without writing it
+  if (ftruncate(result_file.fd, 0) != 0 ||
+      ftruncate(result_file.fd, c.payload_offset + PayloadSize(c)) != 0) {
+    throw std::runtime_error("Cannot write " + result_path);
+  }
+  WriteFully(result_file, &c, sizeof(c), 0);
+
+  int mb = std::min(tile, m);
+  int nb = std::min(tile, n);
+  int kb = std::min(tile, k);
+  long col_blocks = (n + nb - 1) / nb;
+  long depth_blocks = (k + kb - 1) / kb;
+  long steps = (m + mb - 1) / mb * col_blocks * depth_blocks;
+  // Step s multiplies A(i, l) by B(l, j) into C(i, j), l fastest
+  auto row_of = [&](long s) {
+    return static_cast<int>(s / depth_blocks / col_blocks) * mb;
+  };
+  auto col_of = [&](long s) {
+    return static_cast<int>(s / depth_blocks % col_blocks) * nb;
+  };
+  auto depth_of = [&](long s) {
+    return static_cast<int>(s % depth_blocks) * kb;
+  };
+  std::vector<T> a_tiles[2] = {std::vector<T>(static_cast<long>(mb) * kb),
+                               std::vector<T>(static_cast<long>(mb) * kb)};
+  std::vector<T> b_tiles[2] = {std::vector<T>(static_cast<long>(kb) * nb),
+                               std::vector<T>(static_cast<long>(kb) * nb)};
+  std::vector<T> c_tile(static_cast<long>(mb) * nb);
+  auto load = [&](long s) {
+    int i = row_of(s);
+    int j = col_of(s);
+    int l = depth_of(s);
+    int depth = std::min(kb, k - l);
+    ReadBlock(a_file, a, i, l, std::min(mb, m - i), depth,
+              a_tiles[s % 2].data());
+    ReadBlock(b_file, b, l, j, depth, std::min(nb, n - j),
+              b_tiles[s % 2].data());
+  };
+  std::future<void> next = std::async(std::launch::async, load, 0L);
+  for (long s = 0; s < steps; s++) {
+    next.get();
+    if (s + 1 < steps) {
+      next = std::async(std::launch::async, load, s + 1);
+    }
+    int i = row_of(s);
+    int j = col_of(s);
+    int l = depth_of(s);
+    int rows = std::min(mb, m - i);
+    int cols = std::min(nb, n - j);
+    int depth = std::min(kb, k - l);
+    s21::Gemm(rows, cols, depth, T(1), a_tiles[s % 2].data(), depth, 1,
+              b_tiles[s % 2].data(), cols, 1, l == 0 ? T(0) : T(1),
+              c_tile.data(), cols);
+    if (l + depth == k) {
+      WriteBlock(result_file, c, i, j, rows, cols, c_tile.data());
+    }
+  }
+}
+
+// Constructors
+template <typename T>
+S21BasicMappedMatrix<T>::S21BasicMappedMatrix(
+    void* mapping, size_t size, const S21MatrixFileHeader& header)
+    : S21BasicMatrixView<const T>(
+          reinterpret_cast<const T*>(static_cast<const char*>(mapping) +
+                                     header.payload_offset),
+          header.rows, header.cols, header.stride, 1),
+      mapping_(mapping),
+      size_(size) {}
+
+template <typename T>
+S21BasicMappedMatrix<T>::S21BasicMappedMatrix(
+    S21BasicMappedMatrix&& other) noexcept
+    : S21BasicMatrixView<const T>(other),
+      mapping_(other.mapping_),
+      size_(other.size_) {
+  other.mapping_ = nullptr;
+}
+
+// Destructors
+template <typename T>
+S21BasicMappedMatrix<T>::~S21BasicMappedMatrix() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, size_);
+  }
+}
+
+template void S21BasicMatrix<float>::Save(const std::string& path) const;
+template void S21BasicMatrix<double>::Save(const std::string& path) const;
+template S21BasicMatrix<float> S21BasicMatrix<float>::Load(
+    const std::string& path);
+template S21BasicMatrix<double> S21BasicMatrix<double>::Load(
+    const std::string& path);
+template S21BasicMappedMatrix<float> S21BasicMatrix<float>::MapFile(
+    const std::string& path);
+template S21BasicMappedMatrix<double> S21BasicMatrix<double>::MapFile(
+    const std::string& path);
+
+template void S21BasicMatrix<float>::MulFiles(const std::string& a_path,
+                                             const std::string& b_path,
+                                             const std::string& result_path,
+                                             size_t memory_budget);
+template void S21BasicMatrix<double>::MulFiles(const std::string& a_path,
+                                              const std::string& b_path,
+                                              const std::string& result_path,
+                                              size_t memory_budget);
+
+template class S21BasicMappedMatrix<float>;
+template class S21BasicMappedMatrix<double>;
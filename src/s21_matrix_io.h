@@ -0,0 +1,83 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_MATRIX_IO_H_
+#define S21_MATRIX_IO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "s21_matrix_view.h"
+
+// Binary matrix file: this 64-byte header, then the rows exactly as they
+// sit in memory, each padded to `stride` elements so that every row
+// starts on an `alignment` boundary of the file and of a mapping of it.
+struct S21MatrixFileHeader {
+  static constexpr char kMagic[8] = {'S', '2', '1', 'M', 'A', 'T', 'R', 'X'};
+  static constexpr uint32_t kVersion = 1;
+  // Reads back as 0x04030201 on a machine of the other byte order
+  static constexpr uint32_t kByteOrder = 0x01020304;
+
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  // 4 for float, 8 for double elements
+  uint32_t scalar_size;
+  uint32_t alignment;
+  int32_t rows;
+  int32_t cols;
+  int32_t stride;
+  uint32_t reserved;
+  uint64_t payload_offset;
+  uint8_t padding[16];
+};
+
+static_assert(sizeof(S21MatrixFileHeader) == 64,
+              "The file header is one cache line");
+
+// Read-only matrix backed by a memory-mapped file. Pages are read in by the
+// kernel on first touch, so mapping costs the same for any file size. It
+// is a const view, so it works wherever a view of a matrix does, and it
+// unmaps the file when destroyed.
+template <typename T>
+class S21BasicMappedMatrix : public S21BasicMatrixView<const T> {
+  friend class S21BasicMatrix<T>;
+
+ public:
+  // Constructors
+  S21BasicMappedMatrix(S21BasicMappedMatrix&& other) noexcept;
+  S21BasicMappedMatrix(const S21BasicMappedMatrix& other) = delete;
+
+  // Destructors
+  ~S21BasicMappedMatrix();
+
+  // Overloaded
+  S21BasicMappedMatrix& operator=(const S21BasicMappedMatrix& other) = delete;
+
+ private:
+  void* mapping_;
+  size_t size_;
+
+  S21BasicMappedMatrix(void* mapping, size_t size,
+                       const S21MatrixFileHeader& header);
+};
+
+using S21MappedMatrix = S21BasicMappedMatrix<double>;
+using S21MappedMatrixF = S21BasicMappedMatrix<float>;
+
+extern template class S21BasicMappedMatrix<float>;
+extern template class S21BasicMappedMatrix<double>;
+
+#endif  // S21_MATRIX_IO_H_
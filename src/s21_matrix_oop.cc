@@ -15,336 +15,882 @@ limitations under the License.
 
 #include "s21_matrix_oop.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <new>
+#include <numeric>
+#include <vector>
+
+#include "s21_gemm.h"
+#include "s21_lu.h"
+#include "s21_matrix_view.h"
+#include "s21_qr.h"
+#include "s21_result_cache.h"
+#include "s21_strassen.h"
+#include "s21_thread_pool.h"
+#include "s21_transpose.h"
+
+namespace {
+
+// hash_version_ of a matrix whose hash has not been computed
+constexpr uint64_t kNoHash = UINT64_MAX;
+
+// Largest scratch area AssignProduct keeps between calls; a larger one is
+// freed after the product instead of staying with the thread
+constexpr size_t kMaxScratchBytes = 1 << 20;
+
+template <typename T>
+std::atomic<S21BasicResultCache<T>*>& ResultCache() {
+  static std::atomic<S21BasicResultCache<T>*> cache{nullptr};
+  return cache;
+}
+
+}  // namespace
+
 // Constructors
-S21Matrix::S21Matrix() : rows_(1), cols_(1), matrix_(nullptr) {
+template <typename T>
+S21BasicMatrix<T>::S21BasicMatrix()
+    : rows_(1),
+      cols_(1),
+      stride_(0),
+      capacity_(0),
+      matrix_(nullptr),
+      resource_(std::pmr::get_default_resource()),
+      version_(0),
+      hash_(0),
+      hash_version_(kNoHash) {
   CreateMatrix();
 }
 
-S21Matrix::S21Matrix(int rows, int cols)
-    : rows_(rows), cols_(cols), matrix_(nullptr) {
+template <typename T>
+S21BasicMatrix<T>::S21BasicMatrix(int rows, int cols)
+    : S21BasicMatrix(rows, cols, std::pmr::get_default_resource()) {}
+
+template <typename T>
+S21BasicMatrix<T>::S21BasicMatrix(int rows, int cols,
+                                  std::pmr::memory_resource* resource)
+    : rows_(rows),
+      cols_(cols),
+      stride_(0),
+      capacity_(0),
+      matrix_(nullptr),
+      resource_(resource),
+      version_(0),
+      hash_(0),
+      hash_version_(kNoHash) {
   CreateMatrix();
 }
 
-S21Matrix::S21Matrix(const S21Matrix& other) {
-  cols_ = other.cols_;
-  rows_ = other.rows_;
-  this->CreateMatrix();
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      matrix_[i][j] = other.matrix_[i][j];
+// Like std::pmr containers, a copy does not inherit the resource: it would
+// dangle if the source lives in an arena that is reset
+template <typename T>
+S21BasicMatrix<T>::S21BasicMatrix(const S21BasicMatrix& other)
+    : S21BasicMatrix(other, std::pmr::get_default_resource()) {}
+
+template <typename T>
+S21BasicMatrix<T>::S21BasicMatrix(const S21BasicMatrix& other,
+                                  std::pmr::memory_resource* resource)
+    : rows_(other.rows_),
+      cols_(other.cols_),
+      stride_(Stride(other.cols_)),
+      capacity_(other.rows_),
+      resource_(resource),
+      version_(0),
+      hash_(0),
+      hash_version_(kNoHash) {
+  S21_PROFILE(s21::Operation::kCopy, rows_, cols_, 0,
+              2.0 * sizeof(T) * rows_ * stride_);
+  // The copy gets no spare capacity; padding is zero and comes along
+  matrix_ = Allocate(static_cast<size_t>(rows_) * stride_);
+  if (stride_ == other.stride_) {
+    memcpy(matrix_, other.matrix_, sizeof(T) * rows_ * stride_);
+  } else {
+    for (int i = 0; i < rows_; i++) {
+      memcpy(Row(i), other.Row(i), sizeof(T) * stride_);
     }
   }
 }
 
-S21Matrix::S21Matrix(S21Matrix&& other) noexcept {
+template <typename T>
+S21BasicMatrix<T>::S21BasicMatrix(S21BasicMatrix&& other) noexcept
+    : version_(0), hash_(0), hash_version_(kNoHash) {
   cols_ = other.cols_;
   rows_ = other.rows_;
+  stride_ = other.stride_;
+  capacity_ = other.capacity_;
   matrix_ = other.matrix_;
+  resource_ = other.resource_;
   other.matrix_ = nullptr;
-  other.cols_ = other.rows_ = 0;
+  other.cols_ = other.rows_ = other.stride_ = other.capacity_ = 0;
 }
 
 // Destructors
-S21Matrix::~S21Matrix() {
+template <typename T>
+S21BasicMatrix<T>::~S21BasicMatrix() {
   if (matrix_ != nullptr) {
-    for (int i = 0; i < rows_; i++) {
-      delete[] matrix_[i];
-    }
-    delete[] matrix_;
+    Deallocate(matrix_, static_cast<size_t>(capacity_) * stride_);
     matrix_ = nullptr;
   }
-  rows_ = cols_ = 0;
+  rows_ = cols_ = stride_ = capacity_ = 0;
 }
 
 // Mutators
-void S21Matrix::SetRows(int Rows) {
+template <typename T>
+void S21BasicMatrix<T>::SetRows(int Rows) {
   if (Rows != rows_) {
-    S21Matrix res(Rows, cols_);
-    for (int i = 0; i < res.rows_; i++) {
-      for (int j = 0; j < res.cols_; j++) {
-        if (i < this->rows_) {
-          res.matrix_[i][j] = this->matrix_[i][j];
-        }
-      }
+    if (Rows <= 0) {
+      throw std::invalid_argument("Rows and cols must be greater than 0");
     }
-    *this = res;
+    bool moves = Rows > capacity_;
+    S21_PROFILE(s21::Operation::kResize, rows_, cols_, 0,
+                sizeof(T) * stride_ *
+                    (std::max(Rows - rows_, 0) + (moves ? 2.0 * rows_ : 0)));
+    Touch();
+    if (moves) {
+      Reallocate(std::max(Rows, 2 * capacity_), stride_);
+    }
+    if (Rows > rows_) {
+      memset(Row(rows_), 0,
+             sizeof(T) * static_cast<size_t>(Rows - rows_) * stride_);
+    }
+    rows_ = Rows;
   }
 }
 
-void S21Matrix::SetCols(int Cols) {
+template <typename T>
+void S21BasicMatrix<T>::SetCols(int Cols) {
   if (Cols != cols_) {
-    S21Matrix res(rows_, Cols);
-    for (int i = 0; i < res.rows_; i++) {
-      for (int j = 0; j < res.cols_; j++) {
-        if (j < this->cols_) {
-          res.matrix_[i][j] = this->matrix_[i][j];
-        }
-      }
+    if (Cols <= 0) {
+      throw std::invalid_argument("Rows and cols must be greater than 0");
+    }
+    bool moves = Cols > stride_;
+    S21_PROFILE(s21::Operation::kResize, rows_, cols_, 0,
+                sizeof(T) * rows_ *
+                    (std::max(cols_ - Cols, 0) + (moves ? 2.0 * stride_ : 0)));
+    Touch();
+    if (moves) {
+      Reallocate(capacity_, Stride(std::max(Cols, 2 * stride_)));
     }
-    *this = res;
+    // Padding is kept zeroed, so growth needs no work
+    for (int i = 0; i < rows_ && Cols < cols_; i++) {
+      memset(Row(i) + Cols, 0, sizeof(T) * (cols_ - Cols));
+    }
+    cols_ = Cols;
   }
 }
 
-// Accessors
-int S21Matrix::GetRows() { return rows_; }
-
-int S21Matrix::GetCols() { return cols_; }
+template <typename T>
+void S21BasicMatrix<T>::AppendRow(const T* values) {
+  S21_PROFILE(s21::Operation::kResize, rows_, cols_, 0,
+              sizeof(T) * stride_);
+  if (rows_ == capacity_ &&
+      !std::less<const T*>()(values, matrix_) &&
+      std::less<const T*>()(values, Row(capacity_))) {
+    // The row lives in this buffer: the stride stays, so its offset does
+    long offset = values - matrix_;
+    Grow();
+    values = matrix_ + offset;
+  }
+  Grow();
+  Touch();
+  memcpy(Row(rows_), values, sizeof(T) * cols_);
+  memset(Row(rows_) + cols_, 0, sizeof(T) * (stride_ - cols_));
+  rows_++;
+}
 
-// Equals
-bool S21Matrix::EqMatrix(const S21Matrix& other) {
-  bool flag = 1;
-  if (cols_ != other.cols_ || rows_ != other.rows_) {
-    flag = 0;
-  } else {
-    for (int i = 0; i < rows_; i++) {
-      for (int j = 0; j < cols_; j++) {
-        if (fabs(matrix_[i][j] - other.matrix_[i][j]) > 1e-7) {
-          flag = 0;
-        }
-      }
-    }
+template <typename T>
+void S21BasicMatrix<T>::Reserve(int rows, int cols) {
+  if (rows > capacity_ || cols > stride_) {
+    Reallocate(std::max(rows, capacity_), Stride(std::max(cols, stride_)));
   }
-  return flag;
 }
 
-// Multiplications
-void S21Matrix::MulNumber(const double num) {
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      matrix_[i][j] = matrix_[i][j] * num;
-    }
+template <typename T>
+void S21BasicMatrix<T>::ShrinkToFit() {
+  if (capacity_ > rows_ || stride_ > Stride(cols_)) {
+    Reallocate(rows_, Stride(cols_));
   }
 }
 
-void S21Matrix::MulMatrix(const S21Matrix& other) {
-  if (cols_ != other.rows_) {
-    throw std::invalid_argument(
-        "The number of columns of the first matrix is not equal to the number "
-        "of rows of the second matrix");
+// Accessors
+template <typename T>
+std::pmr::memory_resource* S21BasicMatrix<T>::GetResource() const {
+  return resource_;
+}
+
+template <typename T>
+int S21BasicMatrix<T>::GetRows() const { return rows_; }
+
+template <typename T>
+int S21BasicMatrix<T>::GetCols() const { return cols_; }
+
+template <typename T>
+int S21BasicMatrix<T>::GetRowCapacity() const { return capacity_; }
+
+template <typename T>
+int S21BasicMatrix<T>::GetColCapacity() const { return stride_; }
+
+// Equals
+template <typename T>
+bool S21BasicMatrix<T>::EqMatrix(const S21BasicMatrix& other) const {
+  return EqMatrix(other,
+                  S21Tolerance::Absolute(S21ScalarTraits<T>::kTolerance));
+}
+
+template <typename T>
+bool S21BasicMatrix<T>::EqMatrix(const S21BasicMatrix& other,
+                                 const S21Tolerance& tolerance) const {
+  S21_PROFILE(s21::Operation::kEqMatrix, rows_, cols_, Size(),
+              2.0 * sizeof(T) * Size());
+  return cols_ == other.cols_ && rows_ == other.rows_ &&
+         s21::Close(Layout(), other.Layout(), tolerance);
+}
+
+// Concurrent calls on an unmodified matrix store the same values, so the
+// memo needs no lock
+template <typename T>
+uint64_t S21BasicMatrix<T>::Hash() const {
+  if (hash_version_.load(std::memory_order_acquire) == version_) {
+    return hash_.load(std::memory_order_relaxed);
   }
-  S21Matrix new_matrix(rows_, other.cols_);
+  S21_PROFILE(s21::Operation::kHash, rows_, cols_, 0, sizeof(T) * Size());
+  const int shape[] = {rows_, cols_};
+  uint64_t hash = s21::Hash(shape, sizeof(shape), 0);
   for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < other.cols_; j++) {
-      for (int k = 0; k < other.rows_; k++) {
-        new_matrix.matrix_[i][j] += matrix_[i][k] * other.matrix_[k][j];
+    hash = s21::Hash(Row(i), cols_ * sizeof(T), hash);
+  }
+  hash_.store(hash, std::memory_order_relaxed);
+  hash_version_.store(version_, std::memory_order_release);
+  return hash;
+}
+
+// Multiplications
+template <typename T>
+void S21BasicMatrix<T>::MulNumber(const T num) {
+  S21_PROFILE(s21::Operation::kMulNumber, rows_, cols_, Size(),
+              2.0 * sizeof(T) * Size());
+  Touch();
+  s21::ParallelFor(0, rows_, Size(), [&](long lo, long hi) {
+    for (long i = lo; i < hi; i++) {
+      T* row = Row(i);
+      for (int j = 0; j < cols_; j++) {
+        row[j] = row[j] * num;
       }
     }
-  }
-  *this = new_matrix;
+  });
+}
+
+template <typename T>
+void S21BasicMatrix<T>::MulMatrix(const S21BasicMatrix& other) {
+  AssignProduct(other.Layout());
+}
+
+template <typename T>
+S21BasicMatrix<double> S21BasicMatrix<T>::MulMatrixMixed(
+    const S21BasicMatrix& other) const {
+  CheckProduct(cols_, other.rows_);
+  S21_PROFILE(s21::Operation::kMulMatrix, rows_, cols_,
+              2.0 * rows_ * cols_ * other.cols_,
+              sizeof(T) * (Size() + other.Size()) +
+                  sizeof(double) * rows_ * other.cols_);
+  S21BasicMatrix<double> result(rows_, other.cols_);
+  s21::Gemm(rows_, other.cols_, cols_, 1.0, matrix_, stride_, 1,
+            other.matrix_, other.stride_, 1, 0.0, result.matrix_,
+            result.stride_);
+  return result;
 }
 
 // Sum
-void S21Matrix::SumMatrix(const S21Matrix& other) {
+template <typename T>
+void S21BasicMatrix<T>::SumMatrix(const S21BasicMatrix& other) {
   if (rows_ != other.rows_ || cols_ != other.cols_) {
     throw std::invalid_argument("Different matrix dimensions");
   }
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      matrix_[i][j] += other.matrix_[i][j];
+  S21_PROFILE(s21::Operation::kSumMatrix, rows_, cols_, Size(),
+              3.0 * sizeof(T) * Size());
+  Touch();
+  s21::ParallelFor(0, rows_, Size(), [&](long lo, long hi) {
+    for (long i = lo; i < hi; i++) {
+      T* row = Row(i);
+      const T* other_row = other.Row(i);
+      for (int j = 0; j < cols_; j++) {
+        row[j] += other_row[j];
+      }
     }
-  }
+  });
 }
 
 // Sub
-void S21Matrix::SubMatrix(const S21Matrix& other) {
+template <typename T>
+void S21BasicMatrix<T>::SubMatrix(const S21BasicMatrix& other) {
   if (rows_ != other.rows_ || cols_ != other.cols_) {
     throw std::invalid_argument("Different matrix dimensions");
   }
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      matrix_[i][j] -= other.matrix_[i][j];
+  S21_PROFILE(s21::Operation::kSubMatrix, rows_, cols_, Size(),
+              3.0 * sizeof(T) * Size());
+  Touch();
+  s21::ParallelFor(0, rows_, Size(), [&](long lo, long hi) {
+    for (long i = lo; i < hi; i++) {
+      T* row = Row(i);
+      const T* other_row = other.Row(i);
+      for (int j = 0; j < cols_; j++) {
+        row[j] -= other_row[j];
+      }
     }
-  }
+  });
 }
 
 // Transpose
-S21Matrix S21Matrix::Transpose() {
-  S21Matrix new_matrix(cols_, rows_);
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      new_matrix.matrix_[j][i] = matrix_[i][j];
-    }
-  }
+template <typename T>
+S21BasicMatrix<T> S21BasicMatrix<T>::Transpose() const& {
+  S21_PROFILE(s21::Operation::kTranspose, rows_, cols_, 0,
+              2.0 * sizeof(T) * Size());
+  S21BasicMatrix new_matrix(cols_, rows_);
+  s21::Transpose(rows_, cols_, matrix_, stride_, new_matrix.matrix_,
+                 new_matrix.stride_);
   return new_matrix;
 }
 
+template <typename T>
+S21BasicMatrix<T> S21BasicMatrix<T>::Transpose() && {
+  TransposeInPlace();
+  return std::move(*this);
+}
+
+template <typename T>
+void S21BasicMatrix<T>::TransposeInPlace() {
+  S21_PROFILE(s21::Operation::kTransposeInPlace, rows_, cols_, 0,
+              2.0 * sizeof(T) * Size());
+  if (rows_ == cols_) {
+    Touch();
+    s21::TransposeSquare(rows_, matrix_, stride_);
+  } else {
+    *this = Transpose();
+  }
+}
+
+template <typename T>
+S21TransposedView<T> S21BasicMatrix<T>::TransposedView() const {
+  return S21TransposedView<T>(*this);
+}
+
+// Views
+// Writes through the view are not tracked, so taking it counts as one
+template <typename T>
+S21BasicMatrixView<T> S21BasicMatrix<T>::View() {
+  Touch();
+  return S21BasicMatrixView<T>(matrix_, rows_, cols_, stride_, 1);
+}
+
+template <typename T>
+S21BasicMatrixView<const T> S21BasicMatrix<T>::View() const {
+  return S21BasicMatrixView<const T>(matrix_, rows_, cols_, stride_, 1);
+}
+
+template <typename T>
+S21BasicMatrixView<T> S21BasicMatrix<T>::View(int row, int col, int rows,
+                                              int cols, int row_step,
+                                              int col_step) {
+  return View().View(row, col, rows, cols, row_step, col_step);
+}
+
+template <typename T>
+S21BasicMatrixView<const T> S21BasicMatrix<T>::View(int row, int col,
+                                                    int rows, int cols,
+                                                    int row_step,
+                                                    int col_step) const {
+  return View().View(row, col, rows, cols, row_step, col_step);
+}
+
 // Algebra
-double S21Matrix::Determinant() {
+template <typename T>
+T S21BasicMatrix<T>::Determinant() const {
   if (cols_ != rows_) {
     throw std::invalid_argument("The matrix is not square");
   }
-  double result = 0;
-  S21Matrix res = *this;
-  DeterminantExtra(&res, &result);
-  return result;
+  S21BasicResultCache<T>* cache = ResultCache<T>().load();
+  if (cache != nullptr) {
+    if (auto cached = cache->Find(s21::Operation::kDeterminant, *this)) {
+      return cached->At(0, 0);
+    }
+  }
+  // The arithmetic is counted by the factorization
+  S21_PROFILE(s21::Operation::kDeterminant, rows_, cols_, 0, 0);
+  T determinant = S21BasicLU<T>(*this).Determinant();
+  if (cache != nullptr) {
+    S21BasicMatrix result(1, 1);
+    result.Row(0)[0] = determinant;
+    cache->Insert(s21::Operation::kDeterminant, *this, result);
+  }
+  return determinant;
 }
 
-S21Matrix S21Matrix::CalcComplements() {
+template <typename T>
+S21BasicMatrix<T> S21BasicMatrix<T>::CalcComplements() const {
   if (cols_ != rows_) {
     throw std::invalid_argument("The matrix is not square");
   }
-  S21Matrix result(rows_, cols_);
-  CalcComplementsExtra(this, &result);
+  S21BasicResultCache<T>* cache = ResultCache<T>().load();
+  if (cache != nullptr) {
+    if (auto cached = cache->Find(s21::Operation::kCalcComplements, *this)) {
+      return *cached;
+    }
+  }
+  // Inverse from the factors; the factorization counts itself
+  S21_PROFILE(s21::Operation::kCalcComplements, rows_, cols_,
+              4.0 / 3 * rows_ * Size(), 2.0 * sizeof(T) * Size());
+  S21BasicMatrix result(rows_, cols_);
+  if (rows_ == 1) {
+    result.Row(0)[0] = Row(0)[0];
+  } else {
+    S21BasicLU<T> lu(*this);
+    if (!lu.IsSingular()) {
+      // Complements are the transposed adjugate: det(A) * (A^-1)^T. The
+      // pivot test of S21LU follows row and column scaling, so a badly
+      // scaled matrix of full rank takes this path too
+      result = lu.Inverse();
+      result.TransposeInPlace();
+      result.MulNumber(lu.Determinant());
+    } else {
+      CalcComplementsExtra(&result);
+    }
+  }
+  if (cache != nullptr) {
+    cache->Insert(s21::Operation::kCalcComplements, *this, result);
+  }
   return result;
 }
 
-S21Matrix S21Matrix::InverseMatrix() {
+template <typename T>
+S21BasicMatrix<T> S21BasicMatrix<T>::InverseMatrix() const& {
   if (cols_ != rows_) {
     throw std::invalid_argument("The matrix is not square");
   }
-  S21Matrix result(rows_, cols_);
-  InverseMatrixExtra(this, &result);
+  S21BasicResultCache<T>* cache = ResultCache<T>().load();
+  if (cache != nullptr) {
+    if (auto cached = cache->Find(s21::Operation::kInverseMatrix, *this)) {
+      return *cached;
+    }
+  }
+  S21_PROFILE(s21::Operation::kInverseMatrix, rows_, cols_,
+              2.0 * rows_ * Size(), 2.0 * sizeof(T) * Size());
+  S21BasicMatrix result = *this;
+  InverseMatrixExtra(&result);
+  if (cache != nullptr) {
+    cache->Insert(s21::Operation::kInverseMatrix, *this, result);
+  }
   return result;
 }
 
-// Overload operators
-S21Matrix& S21Matrix::operator=(S21Matrix other) {
-  std::swap(cols_, other.cols_);
-  std::swap(rows_, other.rows_);
-  std::swap(matrix_, other.matrix_);
-  return *this;
+// The cache needs the operand after the inverse is known
+template <typename T>
+S21BasicMatrix<T> S21BasicMatrix<T>::InverseMatrix() && {
+  if (cols_ != rows_ || ResultCache<T>().load() != nullptr) {
+    return static_cast<const S21BasicMatrix&>(*this).InverseMatrix();
+  }
+  S21_PROFILE(s21::Operation::kInverseMatrix, rows_, cols_,
+              2.0 * rows_ * Size(), 2.0 * sizeof(T) * Size());
+  Touch();
+  InverseMatrixExtra(this);
+  return std::move(*this);
+}
+
+template <typename T>
+S21BasicMatrix<T> S21BasicMatrix<T>::Solve(const S21BasicMatrix& b) const {
+  if (rows_ == cols_) {
+    return S21BasicLU<T>(*this).Solve(b);
+  }
+  return S21BasicQR<T>(*this).Solve(b);
 }
 
-S21Matrix S21Matrix::operator*(const S21Matrix& other) {
-  S21Matrix res = *this;
-  res.MulMatrix(other);
-  return res;
+template <typename T>
+void S21BasicMatrix<T>::SetResultCache(S21BasicResultCache<T>* cache) {
+  ResultCache<T>().store(cache);
 }
 
-S21Matrix S21Matrix::operator*(const double num) {
-  S21Matrix res = *this;
-  res.MulNumber(num);
-  return res;
+// Overload operators
+// Like std::pmr containers, the target keeps its resource. A buffer from
+// an unequal resource is never adopted: the elements are copied into this
+// buffer when they fit, otherwise into a new one from resource_.
+template <typename T>
+S21BasicMatrix<T>& S21BasicMatrix<T>::operator=(S21BasicMatrix other) {
+  bool same_resource = resource_->is_equal(*other.resource_);
+  if (!same_resource && matrix_ != nullptr && other.rows_ <= capacity_ &&
+      other.cols_ <= stride_) {
+    S21_PROFILE(s21::Operation::kCopy, other.rows_, other.cols_, 0,
+                2.0 * sizeof(T) * other.rows_ * stride_);
+    for (int i = 0; i < other.rows_; i++) {
+      memcpy(Row(i), other.Row(i), sizeof(T) * other.cols_);
+      memset(Row(i) + other.cols_, 0, sizeof(T) * (stride_ - other.cols_));
+    }
+    rows_ = other.rows_;
+    cols_ = other.cols_;
+    Touch();
+    return *this;
+  }
+  S21BasicMatrix own = same_resource ? std::move(other)
+                                     : S21BasicMatrix(other, resource_);
+  std::swap(cols_, own.cols_);
+  std::swap(rows_, own.rows_);
+  std::swap(stride_, own.stride_);
+  std::swap(capacity_, own.capacity_);
+  std::swap(matrix_, own.matrix_);
+  Touch();
+  return *this;
 }
 
-S21Matrix S21Matrix::operator-(const S21Matrix& other) {
-  S21Matrix res = *this;
-  res.SubMatrix(other);
-  return res;
+template <typename T>
+S21BasicMatrix<T> S21BasicMatrix<T>::operator*(
+    const S21BasicMatrix& other) const& {
+  return Product(Layout(), other.Layout());
 }
 
-S21Matrix S21Matrix::operator+(const S21Matrix& other) {
-  S21Matrix res = *this;
-  res.SumMatrix(other);
-  return res;
+template <typename T>
+S21BasicMatrix<T> S21BasicMatrix<T>::operator*(const S21BasicMatrix& other) && {
+  MulMatrix(other);
+  return std::move(*this);
 }
 
-void S21Matrix::operator*=(const double num) {
-  S21Matrix res = *this * num;
-  *this = res;
+template <typename T>
+S21BasicMatrix<T>& S21BasicMatrix<T>::operator*=(const T num) {
+  MulNumber(num);
+  return *this;
 }
 
-void S21Matrix::operator+=(const S21Matrix& other) {
-  S21Matrix res = *this + other;
-  *this = res;
+template <typename T>
+S21BasicMatrix<T>& S21BasicMatrix<T>::operator+=(const S21BasicMatrix& other) {
+  SumMatrix(other);
+  return *this;
+}
+
+template <typename T>
+S21BasicMatrix<T>& S21BasicMatrix<T>::operator-=(const S21BasicMatrix& other) {
+  SubMatrix(other);
+  return *this;
 }
 
-void S21Matrix::operator-=(const S21Matrix& other) {
-  S21Matrix res = *this - other;
-  *this = res;
+template <typename T>
+bool S21BasicMatrix<T>::operator==(const S21BasicMatrix& other) const {
+  return EqMatrix(other);
 }
 
-bool S21Matrix::operator==(const S21Matrix& other) {
-  S21Matrix res = *this;
-  return res.EqMatrix(other);
+template <typename T>
+T& S21BasicMatrix<T>::operator()(int rows, int cols) {
+  if (rows >= rows_ || cols >= cols_ || cols < 0 || rows < 0) {
+    throw std::out_of_range("Index is outside the matrix");
+  }
+  Touch();
+  return Row(rows)[cols];
 }
 
-double& S21Matrix::operator()(int rows, int cols) {
+template <typename T>
+T S21BasicMatrix<T>::operator()(int rows, int cols) const {
   if (rows >= rows_ || cols >= cols_ || cols < 0 || rows < 0) {
     throw std::out_of_range("Index is outside the matrix");
   }
-  return matrix_[rows][cols];
+  return Row(rows)[cols];
 }
 
-void S21Matrix::operator*=(const S21Matrix& other) {
-  S21Matrix res = *this * other;
-  *this = res;
+template <typename T>
+S21BasicMatrix<T>& S21BasicMatrix<T>::operator*=(const S21BasicMatrix& other) {
+  MulMatrix(other);
+  return *this;
 }
 
 // Extra functions
-void S21Matrix::CreateMatrix() {
+template <typename T>
+void S21BasicMatrix<T>::CreateMatrix() {
   if (rows_ <= 0 || cols_ <= 0) {
     throw std::invalid_argument("Rows and cols must be greater than 0");
   }
-  matrix_ = new double*[rows_];
-  for (int i = 0; i < rows_; i++) {
-    matrix_[i] = new double[cols_];
-  }
+  stride_ = Stride(cols_);
+  capacity_ = rows_;
+  matrix_ = Allocate(static_cast<size_t>(rows_) * stride_);
   Input();
 }
 
-void S21Matrix::Input() {
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      matrix_[i][j] = 0;
+template <typename T>
+void S21BasicMatrix<T>::Input() {
+  memset(matrix_, 0, sizeof(T) * rows_ * stride_);
+}
+
+template <typename T>
+int S21BasicMatrix<T>::Stride(int cols) {
+  return (cols + kAlignment / sizeof(T) - 1) /
+         (kAlignment / sizeof(T)) * (kAlignment / sizeof(T));
+}
+
+// Rows past rows_ are left uninitialized; whoever exposes them clears them
+template <typename T>
+void S21BasicMatrix<T>::Reallocate(int capacity, int stride) {
+  T* buffer = Allocate(static_cast<size_t>(capacity) * stride);
+  if (stride == stride_) {
+    memcpy(buffer, matrix_, sizeof(T) * rows_ * stride_);
+  } else {
+    for (int i = 0; i < rows_; i++) {
+      T* row = buffer + static_cast<size_t>(i) * stride;
+      memcpy(row, Row(i), sizeof(T) * cols_);
+      memset(row + cols_, 0, sizeof(T) * (stride - cols_));
     }
   }
+  if (matrix_ != nullptr) {
+    Deallocate(matrix_, static_cast<size_t>(capacity_) * stride_);
+  }
+  matrix_ = buffer;
+  capacity_ = capacity;
+  stride_ = stride;
 }
 
-void S21Matrix::DeterminantExtra(S21Matrix* A, double* result) {
-  int sign = 1;
-  double temp_double = 0;
-  if (A->rows_ == 1) {
-    *result = A->matrix_[0][0];
-  } else if (A->rows_ == 2) {
-    *result = A->matrix_[0][0] * A->matrix_[1][1] -
-              A->matrix_[0][1] * A->matrix_[1][0];
-  } else {
-    S21Matrix temp(A->rows_ - 1, A->cols_ - 1);
-    for (int i = 0; i < A->rows_; i++) {
-      Minor(0, i, &temp, A);
-      temp_double = temp.Determinant();
-      *result += A->matrix_[0][i] * temp_double * sign;
-      sign *= -1;
+template <typename T>
+void S21BasicMatrix<T>::Grow() {
+  if (rows_ == capacity_) {
+    Reallocate(std::max(2 * capacity_, 1), stride_);
+  }
+}
+
+#ifdef S21_MATRIX_COUNT_ALLOCATIONS
+namespace {
+std::atomic<long> allocation_count{0};
+}  // namespace
+
+template <typename T>
+long S21BasicMatrix<T>::GetAllocationCount() { return allocation_count; }
+#endif
+
+template <typename T>
+T* S21BasicMatrix<T>::Allocate(size_t size) {
+#ifdef S21_MATRIX_COUNT_ALLOCATIONS
+  allocation_count++;
+#endif
+  S21_PROFILE_ALLOCATION(sizeof(T) * size);
+  return static_cast<T*>(
+      resource_->allocate(sizeof(T) * size, kAlignment));
+}
+
+template <typename T>
+void S21BasicMatrix<T>::Deallocate(T* buffer, size_t size) {
+  resource_->deallocate(buffer, sizeof(T) * size, kAlignment);
+}
+
+template <typename T>
+void S21BasicMatrix<T>::CheckProduct(int cols, int other_rows) {
+  if (cols != other_rows) {
+    throw std::invalid_argument(
+        "The number of columns of the first matrix is not equal to the number "
+        "of rows of the second matrix");
+  }
+}
+
+template <typename T>
+S21BasicMatrix<T> S21BasicMatrix<T>::Product(const S21MatrixLayout<T>& a,
+                                             const S21MatrixLayout<T>& b) {
+  CheckProduct(a.cols, b.rows);
+  S21_PROFILE(s21::Operation::kMulMatrix, a.rows, a.cols,
+              2.0 * a.rows * a.cols * b.cols,
+              sizeof(T) * (static_cast<double>(a.rows) * a.cols +
+                           static_cast<double>(b.rows) * b.cols +
+                           static_cast<double>(a.rows) * b.cols));
+  S21BasicMatrix result(a.rows, b.cols);
+  s21::Strassen(a.rows, b.cols, a.cols, a.data, a.row_stride, a.col_stride,
+                b.data, b.row_stride, b.col_stride, result.matrix_,
+                result.stride_);
+  return result;
+}
+
+template <typename T>
+void S21BasicMatrix<T>::AssignProduct(const S21MatrixLayout<T>& b) {
+  CheckProduct(cols_, b.rows);
+  int n = b.cols;
+  if (n <= stride_) {
+    // The product fits the current buffer: compute it into a per-thread
+    // scratch area and copy it back, so no matrix buffer is allocated.
+    // B may share this buffer.
+    S21_PROFILE(s21::Operation::kMulMatrix, rows_, cols_,
+                2.0 * rows_ * cols_ * n,
+                sizeof(T) * (Size() + static_cast<double>(b.rows) * n +
+                             static_cast<double>(rows_) * n));
+    Touch();
+    thread_local std::vector<T> scratch;
+    scratch.resize(static_cast<size_t>(rows_) * stride_);
+    s21::Strassen(rows_, n, cols_, matrix_, stride_, 1, b.data,
+                  b.row_stride, b.col_stride, scratch.data(), stride_);
+    for (int i = 0; i < rows_; i++) {
+      memcpy(Row(i), scratch.data() + static_cast<size_t>(i) * stride_,
+             sizeof(T) * n);
+      if (n < cols_) {
+        memset(Row(i) + n, 0, sizeof(T) * (cols_ - n));
+      }
     }
+    if (scratch.capacity() * sizeof(T) > kMaxScratchBytes) {
+      std::vector<T>().swap(scratch);
+    }
+    cols_ = n;
+  } else {
+    *this = Product(Layout(), b);
   }
 }
 
-void S21Matrix::Minor(int rows, int columns, S21Matrix* temp, S21Matrix* A) {
-  int rows_plus_one = 0;
-  int columns_plus_one = 0;
-  for (int i = 0; i < temp->rows_; i++) {
-    if (i == rows) {
-      rows_plus_one++;
+// Complements of a singular matrix from a complete-pivoting factorization
+// P * A * Q = L * U, which reveals the rank. Below rank n - 1 every minor
+// vanishes. At rank n - 1 (last pivot zero) the adjugate is rank one:
+// adj(U) = det(U11) * z * e_n^T with U * z = 0, so
+// adj(A) = sign * det(U11) * (Q * z) * (P^T * y)^T with L^T * y = e_n.
+template <typename T>
+void S21BasicMatrix<T>::CalcComplementsExtra(S21BasicMatrix* result) const {
+  int n = rows_;
+  S21BasicMatrix a(*this);
+  std::vector<int> row_order(n);
+  std::vector<int> col_order(n);
+  std::iota(row_order.begin(), row_order.end(), 0);
+  std::iota(col_order.begin(), col_order.end(), 0);
+  // Pivot tolerance of S21LU: relative to the original row and column
+  std::vector<T> row_scale(n);
+  std::vector<T> col_scale(n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      T value = fabs(a.Row(i)[j]);
+      row_scale[i] = fmax(row_scale[i], value);
+      col_scale[j] = fmax(col_scale[j], value);
+    }
+  }
+  T scale = 1;
+  for (int k = 0; k < n - 1; k++) {
+    int pivot_row = k;
+    int pivot_col = k;
+    for (int i = k; i < n; i++) {
+      for (int j = k; j < n; j++) {
+        if (fabs(a.Row(i)[j]) > fabs(a.Row(pivot_row)[pivot_col])) {
+          pivot_row = i;
+          pivot_col = j;
+        }
+      }
+    }
+    T tolerance = n * S21ScalarTraits<T>::kEpsilon *
+                  std::min(row_scale[row_order[pivot_row]],
+                           col_scale[col_order[pivot_col]]);
+    if (fabs(a.Row(pivot_row)[pivot_col]) <= tolerance) {
+      // Rank below n - 1: result stays zero
+      return;
+    }
+    if (pivot_row != k) {
+      std::swap_ranges(a.Row(k), a.Row(k) + n, a.Row(pivot_row));
+      std::swap(row_order[k], row_order[pivot_row]);
+      scale = -scale;
     }
-    columns_plus_one = 0;
-    for (int j = 0; j < temp->cols_; j++) {
-      if (j == columns) {
-        columns_plus_one++;
+    if (pivot_col != k) {
+      for (int i = 0; i < n; i++) {
+        std::swap(a.Row(i)[k], a.Row(i)[pivot_col]);
       }
-      temp->matrix_[i][j] = A->matrix_[i + rows_plus_one][j + columns_plus_one];
+      std::swap(col_order[k], col_order[pivot_col]);
+      scale = -scale;
+    }
+    T diagonal = a.Row(k)[k];
+    scale *= diagonal;
+    for (int i = k + 1; i < n; i++) {
+      T* row_i = a.Row(i);
+      T factor = row_i[k] / diagonal;
+      row_i[k] = factor;
+      for (int j = k + 1; j < n; j++) {
+        row_i[j] -= factor * a.Row(k)[j];
+      }
+    }
+  }
+  std::vector<T> z(n);
+  z[n - 1] = 1;
+  for (int i = n - 2; i >= 0; i--) {
+    T sum = a.Row(i)[n - 1];
+    for (int k = i + 1; k < n - 1; k++) {
+      sum += a.Row(i)[k] * z[k];
+    }
+    z[i] = -sum / a.Row(i)[i];
+  }
+  std::vector<T> y(n);
+  y[n - 1] = 1;
+  for (int i = n - 2; i >= 0; i--) {
+    T sum = 0;
+    for (int k = i + 1; k < n; k++) {
+      sum += a.Row(k)[i] * y[k];
+    }
+    y[i] = -sum;
+  }
+  for (int i = 0; i < n; i++) {
+    T* row = result->Row(row_order[i]);
+    for (int j = 0; j < n; j++) {
+      row[col_order[j]] = scale * y[i] * z[j];
     }
   }
 }
 
-void S21Matrix::CalcComplementsExtra(S21Matrix* A, S21Matrix* result) {
-  if (A->rows_ == 1) {
-    result->matrix_[0][0] = A->matrix_[0][0];
-  } else {
-    int sign = 1;
-    for (int i = 0; i < A->rows_; i++) {
-      for (int j = 0; j < A->cols_; j++) {
-        S21Matrix temp(A->rows_ - 1, A->cols_ - 1);
-        Minor(i, j, &temp, A);
-        if ((i + j) % 2 == 0) {
-          sign = 1;
-        } else if ((i + j) % 2 != 0) {
-          sign = -1;
+// In-place Gauss-Jordan elimination with partial pivoting: the only
+// buffer is the result itself, which starts as a copy of the input.
+template <typename T>
+void S21BasicMatrix<T>::InverseMatrixExtra(S21BasicMatrix* result) {
+  int n = result->rows_;
+  T norm = result->NormOne();
+  T tolerance = n * S21ScalarTraits<T>::kEpsilon * norm;
+  std::vector<int> pivots(n);
+  for (int k = 0; k < n; k++) {
+    int pivot = k;
+    for (int i = k + 1; i < n; i++) {
+      if (fabs(result->Row(i)[k]) > fabs(result->Row(pivot)[k])) {
+        pivot = i;
+      }
+    }
+    if (fabs(result->Row(pivot)[k]) <= tolerance) {
+      throw std::invalid_argument("Matrix determinant is 0");
+    }
+    pivots[k] = pivot;
+    if (pivot != k) {
+      std::swap_ranges(result->Row(k), result->Row(k) + n,
+                       result->Row(pivot));
+    }
+    T* row_k = result->Row(k);
+    T diagonal = row_k[k];
+    row_k[k] = 1;
+    for (int j = 0; j < n; j++) {
+      row_k[j] /= diagonal;
+    }
+    s21::ParallelFor(0, n, result->Size(), [&](long lo, long hi) {
+      for (long i = lo; i < hi; i++) {
+        if (i != k) {
+          T* row_i = result->Row(i);
+          T factor = row_i[k];
+          row_i[k] = 0;
+          for (int j = 0; j < n; j++) {
+            row_i[j] -= factor * row_k[j];
+          }
         }
-        double temp_double = temp.Determinant();
-        result->matrix_[i][j] = temp_double * sign;
+      }
+    });
+  }
+  for (int k = n - 1; k >= 0; k--) {
+    if (pivots[k] != k) {
+      for (int i = 0; i < n; i++) {
+        std::swap(result->Row(i)[k], result->Row(i)[pivots[k]]);
       }
     }
   }
+  // Reciprocal condition number estimate 1 / (|A|_1 * |A^-1|_1)
+  if (1 / (norm * result->NormOne()) < n * S21ScalarTraits<T>::kEpsilon) {
+    throw std::invalid_argument("Matrix is too ill-conditioned to invert");
+  }
 }
 
-void S21Matrix::InverseMatrixExtra(S21Matrix* A, S21Matrix* result) {
-  double determinant = A->Determinant();
-  if (determinant == 0) {
-    throw std::invalid_argument("Matrix determinant is 0");
+template <typename T>
+T S21BasicMatrix<T>::NormOne() const {
+  T result = 0;
+  for (int j = 0; j < cols_; j++) {
+    T sum = 0;
+    for (int i = 0; i < rows_; i++) {
+      sum += fabs(Row(i)[j]);
+    }
+    result = fmax(result, sum);
   }
-  S21Matrix temp = A->CalcComplements();
-  S21Matrix temp_trantemp = temp.Transpose();
-  temp_trantemp.MulNumber(1 / determinant);
-  *result = temp_trantemp;
-}
\ No newline at end of file
+  return result;
+}
+
+template class S21BasicMatrix<float>;
+template class S21BasicMatrix<double>;
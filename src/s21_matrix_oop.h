@@ -17,73 +17,545 @@ limitations under the License.
 #define S21_MATRIX_OOP_H_
 
 #include <math.h>
+#include <string.h>
 
+#include <atomic>
 #include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "s21_compare.h"
+#include "s21_matrix_expr.h"
+#include "s21_profile.h"
+#include "s21_thread_pool.h"
+
+// Per-scalar constants: kTolerance is the absolute difference under which
+// EqMatrix without a tolerance treats two elements as equal
+template <typename T>
+struct S21ScalarTraits;
+
+template <>
+struct S21ScalarTraits<float> {
+  static constexpr float kTolerance = 1e-4f;
+  static constexpr float kEpsilon = std::numeric_limits<float>::epsilon();
+};
+
+template <>
+struct S21ScalarTraits<double> {
+  static constexpr double kTolerance = 1e-7;
+  static constexpr double kEpsilon = std::numeric_limits<double>::epsilon();
+};
+
+template <typename T>
+class S21BasicLU;
+template <typename T>
+class S21BasicMatrixView;
+template <typename T>
+class S21BasicSparseMatrix;
+template <typename T>
+class S21BasicMappedMatrix;
+template <typename T>
+class S21BasicMatrixBatch;
+template <typename T>
+class S21BasicCholesky;
+template <typename T>
+class S21BasicQR;
+template <typename T>
+class S21BasicResultCache;
+
+// Dense row-major matrix of float or double elements. S21Matrix is the
+// double precision matrix, S21MatrixF the single precision one.
+template <typename T>
+class S21BasicMatrix : public S21MatrixExpr<S21BasicMatrix<T>> {
+  template <typename U>
+  friend class S21BasicMatrix;
+  friend class S21BasicLU<T>;
+  template <typename L, typename R, typename Op>
+  friend class S21MatrixBinaryExpr;
+  template <typename E>
+  friend class S21MatrixScaledExpr;
+  friend class S21TransposedView<T>;
+  template <typename U>
+  friend class S21BasicMatrixView;
+  friend class S21BasicSparseMatrix<T>;
+  friend class S21BasicMatrixBatch<T>;
+  friend class S21BasicCholesky<T>;
+  friend class S21BasicQR<T>;
+  template <int R, int C, typename U>
+  friend class S21FixedMatrix;
+  template <typename L, typename R>
+  friend S21BasicMatrix<typename L::Scalar> operator*(
+      const S21MatrixExpr<L>& lhs, const S21MatrixExpr<R>& rhs);
 
-class S21Matrix {
  public:
+  using Scalar = T;
+
   // Constructors
-  S21Matrix();
-  S21Matrix(int rows, int cols);
-  S21Matrix(const S21Matrix& other);
-  S21Matrix(S21Matrix&& other) noexcept;
+  S21BasicMatrix();
+  S21BasicMatrix(int rows, int cols);
+  S21BasicMatrix(int rows, int cols, std::pmr::memory_resource* resource);
+  S21BasicMatrix(const S21BasicMatrix& other);
+  S21BasicMatrix(const S21BasicMatrix& other,
+                 std::pmr::memory_resource* resource);
+  S21BasicMatrix(S21BasicMatrix&& other) noexcept;
+  template <typename E>
+  S21BasicMatrix(const S21MatrixExpr<E>& expr);
 
   // Destructors
-  ~S21Matrix();
+  ~S21BasicMatrix();
 
   // Accessors
+  // Storage grows geometrically and never shrinks by itself, so repeated
+  // growth is amortized O(1) per element and shrinking is free. Rows and
+  // cols within the capacity keep the buffer; anything beyond moves it,
+  // which invalidates views and references like std::vector does.
   void SetRows(int Rows);
   void SetCols(int Cols);
+  // Appends a row of GetCols() elements
+  void AppendRow(const T* values);
+  template <typename E>
+  void AppendRow(const S21MatrixExpr<E>& row);
+  // Makes room for rows x cols without changing the shape
+  void Reserve(int rows, int cols);
+  // Releases the capacity beyond the current shape
+  void ShrinkToFit();
 
   // Mutators
-  int GetRows();
-  int GetCols();
+  std::pmr::memory_resource* GetResource() const;
+  int GetRows() const;
+  int GetCols() const;
+  int GetRowCapacity() const;
+  int GetColCapacity() const;
+  S21MatrixLayout<T> Layout() const {
+    return {matrix_, rows_, cols_, stride_, 1};
+  }
+  bool Aliases(const S21MatrixLayout<T>& target) const {
+    return Layout().Conflicts(target);
+  }
+
+  // Views (declared in s21_matrix_view.h)
+  S21BasicMatrixView<T> View();
+  S21BasicMatrixView<const T> View() const;
+  S21BasicMatrixView<T> View(int row, int col, int rows, int cols,
+                             int row_step = 1, int col_step = 1);
+  S21BasicMatrixView<const T> View(int row, int col, int rows, int cols,
+                                   int row_step = 1, int col_step = 1) const;
 
   // Equals
-  bool EqMatrix(const S21Matrix& other);
+  bool EqMatrix(const S21BasicMatrix& other) const;
+  // Under S21Tolerance::Bitwise() rows are compared with memcmp. Memoized
+  // Hash() values are not consulted: a reference taken before Hash() can
+  // still change the elements, and a stale hash would reject equal
+  // matrices.
+  bool EqMatrix(const S21BasicMatrix& other,
+                const S21Tolerance& tolerance) const;
+  template <typename E>
+  bool EqMatrix(const S21MatrixExpr<E>& other) const;
+  template <typename E>
+  bool EqMatrix(const S21MatrixExpr<E>& other,
+                const S21Tolerance& tolerance) const;
+  // XXH64 of the shape and the elements row by row, so matrices equal
+  // under S21Tolerance::Bitwise() hash the same whatever their stride.
+  // Memoized until the matrix is modified. Taking a reference with
+  // operator() or a view with View() counts as a modification; writes
+  // through them after a later Hash() call are not seen.
+  uint64_t Hash() const;
 
   // Multiplication
-  void MulNumber(const double num);
-  void MulMatrix(const S21Matrix& other);
+  void MulNumber(const T num);
+  void MulMatrix(const S21BasicMatrix& other);
+  template <typename E>
+  void MulMatrix(const S21MatrixExpr<E>& other);
+  // Product with every multiply-add accumulated in double precision
+  S21BasicMatrix<double> MulMatrixMixed(const S21BasicMatrix& other) const;
 
   // Sum
-  void SumMatrix(const S21Matrix& other);
+  void SumMatrix(const S21BasicMatrix& other);
+  template <typename E>
+  void SumMatrix(const S21MatrixExpr<E>& other);
 
   // Sub
-  void SubMatrix(const S21Matrix& other);
+  void SubMatrix(const S21BasicMatrix& other);
+  template <typename E>
+  void SubMatrix(const S21MatrixExpr<E>& other);
 
-  // Transpose
-  S21Matrix Transpose();
+  // Transpose. An expiring square matrix is transposed in its own buffer
+  S21BasicMatrix Transpose() const&;
+  S21BasicMatrix Transpose() &&;
+  // Square matrices are transposed without allocating
+  void TransposeInPlace();
+  // Lazy transpose: A.TransposedView() * B runs as one GEMM call
+  S21TransposedView<T> TransposedView() const;
+
+  // Files (s21_matrix_io.h describes the format)
+  void Save(const std::string& path) const;
+  static S21BasicMatrix Load(const std::string& path);
+  // Maps the file instead of reading it: returns at once, pages come in
+  // on first access
+  static S21BasicMappedMatrix<T> MapFile(const std::string& path);
+  // Writes A * B of two matrix files to a third one. Tiles are streamed
+  // through about memory_budget bytes of buffers, reading the next tiles
+  // while the current ones are multiplied, so the operands and the result
+  // never have to fit in memory
+  static void MulFiles(const std::string& a_path, const std::string& b_path,
+                       const std::string& result_path, size_t memory_budget);
 
   // Algebra
-  double Determinant();
-  S21Matrix InverseMatrix();
-  S21Matrix CalcComplements();
+  T Determinant() const;
+  // An expiring matrix is inverted in its own buffer unless a result
+  // cache is set
+  S21BasicMatrix InverseMatrix() const&;
+  S21BasicMatrix InverseMatrix() &&;
+  S21BasicMatrix CalcComplements() const;
+  // X with A * X = B without forming A^-1: LU for a square A, least
+  // squares by QR when A has more rows than cols. To reuse the
+  // factorization for many B, keep an S21LU, S21Cholesky or S21QR.
+  S21BasicMatrix Solve(const S21BasicMatrix& b) const;
+  // Makes Determinant(), InverseMatrix() and CalcComplements() of every
+  // matrix of this element type look in the cache first and store what
+  // they compute; nullptr, the default, turns caching off
+  static void SetResultCache(S21BasicResultCache<T>* cache);
 
   // Overloaded
-  void operator*=(const double num);
-  double& operator()(int row, int col);
-  S21Matrix& operator=(S21Matrix other);
-  S21Matrix operator*(const double num);
-  void operator*=(const S21Matrix& other);
-  void operator+=(const S21Matrix& other);
-  void operator-=(const S21Matrix& other);
-  bool operator==(const S21Matrix& other);
-  S21Matrix operator*(const S21Matrix& other);
-  S21Matrix operator-(const S21Matrix& other);
-  S21Matrix operator+(const S21Matrix& other);
+  S21BasicMatrix& operator*=(const T num);
+  T& operator()(int row, int col);
+  // Reads do not count as a modification
+  T operator()(int row, int col) const;
+  S21BasicMatrix& operator=(S21BasicMatrix other);
+  template <typename E>
+  S21BasicMatrix& operator=(const S21MatrixExpr<E>& expr);
+  S21BasicMatrix& operator*=(const S21BasicMatrix& other);
+  template <typename E>
+  S21BasicMatrix& operator*=(const S21MatrixExpr<E>& other);
+  S21BasicMatrix& operator+=(const S21BasicMatrix& other);
+  S21BasicMatrix& operator-=(const S21BasicMatrix& other);
+  template <typename E>
+  S21BasicMatrix& operator+=(const S21MatrixExpr<E>& expr);
+  template <typename E>
+  S21BasicMatrix& operator-=(const S21MatrixExpr<E>& expr);
+  bool operator==(const S21BasicMatrix& other) const;
+  template <typename E>
+  bool operator==(const S21MatrixExpr<E>& other) const;
+  // An expiring left operand holds the product when it fits its stride.
+  // The free operators below reuse expiring operands of +, - and scaling
+  S21BasicMatrix operator*(const S21BasicMatrix& other) const&;
+  S21BasicMatrix operator*(const S21BasicMatrix& other) &&;
+  template <typename E>
+  S21BasicMatrix operator*(const S21MatrixExpr<E>& other) const&;
+  template <typename E>
+  S21BasicMatrix operator*(const S21MatrixExpr<E>& other) &&;
+
+#ifdef S21_MATRIX_COUNT_ALLOCATIONS
+  // Number of element buffers allocated so far (test builds only)
+  static long GetAllocationCount();
+#endif
 
  private:
+  // Rows start on cache line boundaries inside one contiguous buffer
+  static constexpr size_t kAlignment = 64;
+
   int rows_;
   int cols_;
-  double** matrix_;
+  int stride_;
+  // Rows allocated; row padding up to stride_ is the column capacity
+  int capacity_;
+  T* matrix_;
+  std::pmr::memory_resource* resource_;
+  // Incremented by every modification
+  uint64_t version_;
+  // Hash() of the version hash_version_, written only by Hash()
+  mutable std::atomic<uint64_t> hash_;
+  mutable std::atomic<uint64_t> hash_version_;
 
   // Extra functions
   void Input();
   void CreateMatrix();
-  void DeterminantExtra(S21Matrix* A, double* result);
-  void InverseMatrixExtra(S21Matrix* A, S21Matrix* result);
-  void CalcComplementsExtra(S21Matrix* A, S21Matrix* result);
-  void Minor(int rows, int columns, S21Matrix* temp, S21Matrix* A);
+  void Touch() { version_++; }
+  T* Row(long row) const { return matrix_ + row * stride_; }
+  long Size() const { return static_cast<long>(rows_) * cols_; }
+  T At(long row, int col) const { return Row(row)[col]; }
+  template <typename E>
+  void Evaluate(const E& expr);
+  static int Stride(int cols);
+  // Moves the rows to a buffer of capacity rows of stride elements
+  void Reallocate(int capacity, int stride);
+  // Makes room for one more row
+  void Grow();
+  T* Allocate(size_t size);
+  void Deallocate(T* buffer, size_t size);
+  static void CheckProduct(int cols, int other_rows);
+  static S21BasicMatrix Product(const S21MatrixLayout<T>& a,
+                                const S21MatrixLayout<T>& b);
+  // Replaces this matrix with its product by B
+  void AssignProduct(const S21MatrixLayout<T>& b);
+  static void InverseMatrixExtra(S21BasicMatrix* result);
+  T NormOne() const;
+  void CalcComplementsExtra(S21BasicMatrix* result) const;
 };
-#endif  // S21_MATRIX_OOP_H_
\ No newline at end of file
+
+using S21Matrix = S21BasicMatrix<double>;
+using S21MatrixF = S21BasicMatrix<float>;
+
+extern template class S21BasicMatrix<float>;
+extern template class S21BasicMatrix<double>;
+
+template <typename T>
+template <typename E>
+S21BasicMatrix<T>::S21BasicMatrix(const S21MatrixExpr<E>& expr)
+    : S21BasicMatrix(expr.Self().GetRows(), expr.Self().GetCols()) {
+  Evaluate(expr.Self());
+}
+
+template <typename T>
+template <typename E>
+S21BasicMatrix<T>& S21BasicMatrix<T>::operator=(const S21MatrixExpr<E>& expr) {
+  if (expr.Self().GetRows() == rows_ && expr.Self().GetCols() == cols_ &&
+      !expr.Self().Aliases(Layout())) {
+    // Same shape and each element reads only the element being written
+    Evaluate(expr.Self());
+  } else {
+    *this = S21BasicMatrix(expr);
+  }
+  return *this;
+}
+
+// When the buffer has to move the row is evaluated into a temporary
+// first: it may read this matrix, with or without a layout that Aliases()
+// reports. That happens only on growth, so appends stay amortized O(1).
+template <typename T>
+template <typename E>
+void S21BasicMatrix<T>::AppendRow(const S21MatrixExpr<E>& row) {
+  static_assert(std::is_same<typename E::Scalar, T>::value,
+                "Expression and matrix element types differ");
+  const E& expr = row.Self();
+  if (expr.GetRows() != 1 || expr.GetCols() != cols_) {
+    throw std::invalid_argument("Different matrix dimensions");
+  }
+  if (rows_ == capacity_) {
+    AppendRow(S21BasicMatrix(expr).matrix_);
+    return;
+  }
+  S21_PROFILE(s21::Operation::kResize, rows_, cols_, 0,
+              sizeof(T) * stride_);
+  Grow();
+  Touch();
+  T* target = Row(rows_);
+  for (int j = 0; j < cols_; j++) {
+    target[j] = expr.At(0, j);
+  }
+  memset(target + cols_, 0, sizeof(T) * (stride_ - cols_));
+  rows_++;
+}
+
+template <typename T>
+template <typename E>
+S21BasicMatrix<T>& S21BasicMatrix<T>::operator+=(
+    const S21MatrixExpr<E>& expr) {
+  if (!expr.Self().Aliases(Layout())) {
+    Evaluate(*this + expr.Self());
+  } else {
+    *this = S21BasicMatrix(*this + expr.Self());
+  }
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+S21BasicMatrix<T>& S21BasicMatrix<T>::operator-=(
+    const S21MatrixExpr<E>& expr) {
+  if (!expr.Self().Aliases(Layout())) {
+    Evaluate(*this - expr.Self());
+  } else {
+    *this = S21BasicMatrix(*this - expr.Self());
+  }
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+S21BasicMatrix<T>& S21BasicMatrix<T>::operator*=(
+    const S21MatrixExpr<E>& other) {
+  MulMatrix(other);
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+void S21BasicMatrix<T>::SumMatrix(const S21MatrixExpr<E>& other) {
+  // The pass itself is counted as kEvaluate
+  S21_PROFILE(s21::Operation::kSumMatrix, rows_, cols_, 0, 0);
+  *this += other;
+}
+
+template <typename T>
+template <typename E>
+void S21BasicMatrix<T>::SubMatrix(const S21MatrixExpr<E>& other) {
+  S21_PROFILE(s21::Operation::kSubMatrix, rows_, cols_, 0, 0);
+  *this -= other;
+}
+
+// Strided operands are multiplied where they are; any other expression is
+// evaluated first
+template <typename T>
+template <typename E>
+void S21BasicMatrix<T>::MulMatrix(const S21MatrixExpr<E>& other) {
+  if constexpr (S21IsStridedExpr<E>::value) {
+    AssignProduct(other.Self().Layout());
+  } else {
+    MulMatrix(S21BasicMatrix(other));
+  }
+}
+
+template <typename T>
+template <typename E>
+bool S21BasicMatrix<T>::EqMatrix(const S21MatrixExpr<E>& other) const {
+  return EqMatrix(other,
+                  S21Tolerance::Absolute(S21ScalarTraits<T>::kTolerance));
+}
+
+// Strided operands of the same element type are compared by the vector
+// kernels; anything else element by element
+template <typename T>
+template <typename E>
+bool S21BasicMatrix<T>::EqMatrix(const S21MatrixExpr<E>& other,
+                                 const S21Tolerance& tolerance) const {
+  S21_PROFILE(s21::Operation::kEqMatrix, rows_, cols_, Size(),
+              2.0 * sizeof(T) * Size());
+  const E& expr = other.Self();
+  if (cols_ != expr.GetCols() || rows_ != expr.GetRows()) return false;
+  if constexpr (S21IsStridedExpr<E>::value &&
+                std::is_same<typename E::Scalar, T>::value) {
+    return s21::Close(Layout(), expr.Layout(), tolerance);
+  } else {
+    for (int i = 0; i < rows_; i++) {
+      for (int j = 0; j < cols_; j++) {
+        if (!s21::ElementClose<T>(At(i, j), expr.At(i, j), tolerance)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+}
+
+template <typename T>
+template <typename E>
+bool S21BasicMatrix<T>::operator==(const S21MatrixExpr<E>& other) const {
+  return EqMatrix(other);
+}
+
+// Single fused pass over the result for the whole expression tree
+template <typename T>
+template <typename E>
+void S21BasicMatrix<T>::Evaluate(const E& expr) {
+  static_assert(std::is_same<typename E::Scalar, T>::value,
+                "Expression and matrix element types differ");
+  Touch();
+  // One operation and one store per element; what the tree reads is not
+  // tracked
+  S21_PROFILE(s21::Operation::kEvaluate, rows_, cols_, Size(),
+              sizeof(T) * Size());
+  s21::ParallelFor(0, rows_, Size(), [&](long lo, long hi) {
+    for (long i = lo; i < hi; i++) {
+      T* row = Row(i);
+      for (int j = 0; j < cols_; j++) {
+        row[j] = expr.At(i, j);
+      }
+    }
+  });
+}
+
+// Strided operands go to GEMM where they are; any other expression is
+// evaluated into a matrix first
+template <typename L, typename R>
+S21BasicMatrix<typename L::Scalar> operator*(const S21MatrixExpr<L>& lhs,
+                                             const S21MatrixExpr<R>& rhs) {
+  using T = typename L::Scalar;
+  if constexpr (!S21IsStridedExpr<L>::value) {
+    return S21BasicMatrix<T>(lhs.Self()) * rhs.Self();
+  } else if constexpr (!S21IsStridedExpr<R>::value) {
+    return lhs.Self() * S21BasicMatrix<T>(rhs.Self());
+  } else {
+    return S21BasicMatrix<T>::Product(lhs.Self().Layout(),
+                                      rhs.Self().Layout());
+  }
+}
+
+template <typename T>
+template <typename E>
+S21BasicMatrix<T> S21BasicMatrix<T>::operator*(
+    const S21MatrixExpr<E>& other) const& {
+  return ::operator*(*this, other);
+}
+
+template <typename T>
+template <typename E>
+S21BasicMatrix<T> S21BasicMatrix<T>::operator*(
+    const S21MatrixExpr<E>& other) && {
+  MulMatrix(other);
+  return std::move(*this);
+}
+
+// An expiring matrix operand takes the result. Evaluation is in place,
+// element by element, unless the other operand overlaps it otherwise.
+template <typename T, typename R>
+S21BasicMatrix<T> operator+(S21BasicMatrix<T>&& lhs,
+                            const S21MatrixExpr<R>& rhs) {
+  lhs += rhs;
+  return std::move(lhs);
+}
+
+template <typename L, typename T>
+S21BasicMatrix<T> operator+(const S21MatrixExpr<L>& lhs,
+                            S21BasicMatrix<T>&& rhs) {
+  rhs = lhs.Self() + rhs;
+  return std::move(rhs);
+}
+
+template <typename T>
+S21BasicMatrix<T> operator+(S21BasicMatrix<T>&& lhs,
+                            S21BasicMatrix<T>&& rhs) {
+  lhs += rhs;
+  return std::move(lhs);
+}
+
+template <typename T, typename R>
+S21BasicMatrix<T> operator-(S21BasicMatrix<T>&& lhs,
+                            const S21MatrixExpr<R>& rhs) {
+  lhs -= rhs;
+  return std::move(lhs);
+}
+
+template <typename L, typename T>
+S21BasicMatrix<T> operator-(const S21MatrixExpr<L>& lhs,
+                            S21BasicMatrix<T>&& rhs) {
+  rhs = lhs.Self() - rhs;
+  return std::move(rhs);
+}
+
+template <typename T>
+S21BasicMatrix<T> operator-(S21BasicMatrix<T>&& lhs,
+                            S21BasicMatrix<T>&& rhs) {
+  lhs -= rhs;
+  return std::move(lhs);
+}
+
+template <typename T>
+S21BasicMatrix<T> operator*(S21BasicMatrix<T>&& matrix,
+                            const typename S21BasicMatrix<T>::Scalar num) {
+  matrix.MulNumber(num);
+  return std::move(matrix);
+}
+
+template <typename T>
+S21BasicMatrix<T> operator*(const typename S21BasicMatrix<T>::Scalar num,
+                            S21BasicMatrix<T>&& matrix) {
+  matrix.MulNumber(num);
+  return std::move(matrix);
+}
+
+#endif  // S21_MATRIX_OOP_H_
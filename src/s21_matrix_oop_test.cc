@@ -15,6 +15,28 @@ limitations under the License.
 #include "s21_matrix_oop.h"
 
 #include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <utility>
+
+#include "s21_fixed_matrix.h"
+#include "s21_cholesky.h"
+#include "s21_compare.h"
+#include "s21_gemm.h"
+#include "s21_lu.h"
+#include "s21_matrix_batch.h"
+#include "s21_matrix_io.h"
+#include "s21_matrix_view.h"
+#include "s21_memory.h"
+#include "s21_profile.h"
+#include "s21_qr.h"
+#include "s21_result_cache.h"
+#include "s21_sparse_matrix.h"
+#include "s21_strassen.h"
+#include "s21_thread_pool.h"
 
 TEST(Test_1, Mutators_and_BasicConstructor) {
   S21Matrix a;
@@ -407,6 +429,1620 @@ TEST(Test_23, CalcCompExtra) {
   ASSERT_TRUE(b(0, 0) == 5);
 }
 
+TEST(Test_24, DeterminantSingular) {
+  S21Matrix a(3, 3);
+  for (int i = 0; i < a.GetRows(); i++) {
+    for (int j = 0; j < a.GetCols(); j++) {
+      a(i, j) = i * 3 + j + 1;
+    }
+  }
+  EXPECT_EQ(a.Determinant(), 0);
+  a.SetRows(4);
+  a.SetCols(4);
+  ASSERT_TRUE(a.Determinant() == 0);
+  S21Matrix b(2, 3);
+  EXPECT_THROW(b.Determinant(), std::invalid_argument);
+
+  // Badly scaled but nonsingular: the pivot tolerance scales with the
+  // rows and columns, so the small pivots still make up the determinant
+  const double diagonals[][3] = {{1e8, 1e-8, 1}, {1e9, 1, 1e-9},
+                                 {1e5, 1e-12, 1}};
+  for (const auto& diagonal : diagonals) {
+    S21Matrix d(3, 3);
+    for (int i = 0; i < 3; i++) {
+      d(i, i) = diagonal[i];
+    }
+    d(0, 1) = 1;
+    d(2, 0) = 1e-3;
+    double expected = diagonal[0] * diagonal[1] * diagonal[2];
+    ASSERT_NEAR(d.Determinant(), expected, 1e-12 * expected);
+  }
+  S21Matrix d(2, 2);
+  d(0, 0) = 1e8;
+  d(1, 1) = 1e-8;
+  ASSERT_TRUE(d.Determinant() == 1);
+  ASSERT_FALSE(S21LU(d).IsSingular());
+  ASSERT_TRUE(S21LU(d).Inverse()(1, 1) == 1e8);
+  S21Matrix sixteen(4, 4);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      sixteen(i, j) = i * 4 + j + 1;
+    }
+  }
+  EXPECT_EQ(sixteen.Determinant(), 0);
+  ASSERT_TRUE(S21LU(sixteen).IsSingular());
+}
+
+TEST(Test_25, DeterminantLarge) {
+  S21Matrix a(20, 20);
+  for (int i = 0; i < a.GetRows(); i++) {
+    a(i, i) = 2;
+    if (i > 0) {
+      a(i, i - 1) = -1;
+      a(i - 1, i) = -1;
+    }
+  }
+  ASSERT_NEAR(a.Determinant(), 21, 1e-9);
+}
+
+TEST(Test_26, LUFactors) {
+  S21Matrix a(2, 2);
+  a(0, 0) = 1;
+  a(0, 1) = 2;
+  a(1, 0) = 3;
+  a(1, 1) = 4;
+  S21LU lu(a);
+  ASSERT_TRUE(lu.GetSize() == 2);
+  ASSERT_TRUE(lu.GetPivots()[0] == 1);
+  ASSERT_FALSE(lu.IsSingular());
+  ASSERT_NEAR(lu.Determinant(), -2, 1e-12);
+}
+
+TEST(Test_27, InverseSingular) {
+  S21Matrix a(3, 3);
+  for (int i = 0; i < a.GetRows(); i++) {
+    for (int j = 0; j < a.GetCols(); j++) {
+      a(i, j) = i * 3 + j + 1;
+    }
+  }
+  EXPECT_THROW(a.InverseMatrix(), std::invalid_argument);
+  S21Matrix hilbert(12, 12);
+  for (int i = 0; i < hilbert.GetRows(); i++) {
+    for (int j = 0; j < hilbert.GetCols(); j++) {
+      hilbert(i, j) = 1.0 / (i + j + 1);
+    }
+  }
+  EXPECT_THROW(hilbert.InverseMatrix(), std::invalid_argument);
+}
+
+TEST(Test_28, InverseLarge) {
+  S21Matrix a(50, 50);
+  for (int i = 0; i < a.GetRows(); i++) {
+    for (int j = 0; j < a.GetCols(); j++) {
+      a(i, j) = (i == j) ? 50 : (i * 7 + j * 3) % 5;
+    }
+  }
+  S21Matrix product = a * a.InverseMatrix();
+  S21Matrix identity(50, 50);
+  for (int i = 0; i < identity.GetRows(); i++) {
+    identity(i, i) = 1;
+  }
+  ASSERT_TRUE(product == identity);
+}
+
+TEST(Test_29, ResizeKeepsData) {
+  S21Matrix a(3, 3);
+  for (int i = 0; i < a.GetRows(); i++) {
+    for (int j = 0; j < a.GetCols(); j++) {
+      a(i, j) = i * 3 + j + 1;
+    }
+  }
+  a.SetCols(2);
+  a.SetCols(12);
+  a.SetRows(2);
+  a.SetRows(4);
+  ASSERT_TRUE(a.GetRows() == 4);
+  ASSERT_TRUE(a.GetCols() == 12);
+  for (int i = 0; i < a.GetRows(); i++) {
+    for (int j = 0; j < a.GetCols(); j++) {
+      double expected = (i < 2 && j < 2) ? i * 3 + j + 1 : 0;
+      ASSERT_TRUE(a(i, j) == expected);
+    }
+  }
+  EXPECT_THROW(a.SetRows(0), std::invalid_argument);
+  EXPECT_THROW(a(4, 0), std::out_of_range);
+}
+
+TEST(Test_30, MulMatrixBlocked) {
+  S21Matrix a(70, 301);
+  S21Matrix b(301, 91);
+  for (int i = 0; i < a.GetRows(); i++) {
+    for (int j = 0; j < a.GetCols(); j++) {
+      a(i, j) = (i * 13 + j * 7) % 11 - 5;
+    }
+  }
+  for (int i = 0; i < b.GetRows(); i++) {
+    for (int j = 0; j < b.GetCols(); j++) {
+      b(i, j) = (i * 3 + j * 17) % 7 - 3;
+    }
+  }
+  S21Matrix c = a * b;
+  ASSERT_TRUE(c.GetRows() == 70);
+  ASSERT_TRUE(c.GetCols() == 91);
+  for (int i = 0; i < c.GetRows(); i++) {
+    for (int j = 0; j < c.GetCols(); j++) {
+      double expected = 0;
+      for (int k = 0; k < a.GetCols(); k++) {
+        expected += a(i, k) * b(k, j);
+      }
+      ASSERT_TRUE(c(i, j) == expected);
+    }
+  }
+  S21Matrix d(3, 4);
+  EXPECT_THROW(a.MulMatrix(d), std::invalid_argument);
+}
+
+TEST(Test_31, GemmStrides) {
+  double a[40 * 50];
+  double b[50 * 60];
+  double c[40 * 60];
+  for (int i = 0; i < 40 * 50; i++) {
+    a[i] = i % 9 - 4;
+  }
+  for (int i = 0; i < 50 * 60; i++) {
+    b[i] = i % 5 - 2;
+  }
+  for (int i = 0; i < 40 * 60; i++) {
+    c[i] = 1;
+  }
+  // A is stored transposed (50 x 40), C = 2 * A * B - C
+  s21::Gemm(40, 60, 50, 2, a, 1, 40, b, 60, 1, -1, c, 60);
+  for (int i = 0; i < 40; i++) {
+    for (int j = 0; j < 60; j++) {
+      double expected = -1;
+      for (int k = 0; k < 50; k++) {
+        expected += 2 * a[k * 40 + i] * b[k * 60 + j];
+      }
+      ASSERT_TRUE(c[i * 60 + j] == expected);
+    }
+  }
+}
+
+TEST(Test_32, ThreadPoolParallelFor) {
+  s21::SetNumThreads(4);
+  ASSERT_TRUE(s21::GetNumThreads() == 4);
+  std::vector<std::atomic<int>> hits(1000);
+  s21::ThreadPool::Instance().ParallelFor(0, 1000, 7, [&](long lo, long hi) {
+    for (long i = lo; i < hi; i++) {
+      hits[i]++;
+      // Nested calls run inline on the current thread
+      s21::ThreadPool::Instance().ParallelFor(0, 2, 1, [](long, long) {});
+    }
+  });
+  for (auto& hit : hits) {
+    ASSERT_TRUE(hit == 1);
+  }
+  EXPECT_THROW(s21::ThreadPool::Instance().ParallelFor(
+                   0, 100, 1,
+                   [](long lo, long hi) {
+                     if (lo <= 50 && 50 < hi) {
+                       throw std::out_of_range("chunk");
+                     }
+                   }),
+               std::out_of_range);
+  EXPECT_THROW(s21::SetNumThreads(0), std::invalid_argument);
+
+  // While one application thread's region holds the pool, another one's
+  // runs inline on that thread instead of adding busy threads
+  std::atomic<bool> started{false};
+  std::atomic<bool> finished{false};
+  std::thread owner([&] {
+    s21::ThreadPool::Instance().ParallelFor(0, 8, 1, [&](long lo, long) {
+      if (lo == 0) {
+        started = true;
+        while (!finished) std::this_thread::yield();
+      }
+    });
+  });
+  while (!started) std::this_thread::yield();
+  std::vector<std::pair<long, long>> chunks;
+  std::thread::id caller = std::this_thread::get_id();
+  bool inline_only = true;
+  s21::ThreadPool::Instance().ParallelFor(0, 100, 1, [&](long lo, long hi) {
+    chunks.emplace_back(lo, hi);
+    inline_only = inline_only && std::this_thread::get_id() == caller;
+  });
+  finished = true;
+  owner.join();
+  ASSERT_EQ(chunks.size(), 1u);
+  ASSERT_EQ(chunks[0], std::make_pair(0L, 100L));
+  ASSERT_TRUE(inline_only);
+  s21::SetNumThreads(1);
+}
+
+TEST(Test_33, ParallelOperations) {
+  S21Matrix a(130, 130);
+  for (int i = 0; i < a.GetRows(); i++) {
+    for (int j = 0; j < a.GetCols(); j++) {
+      a(i, j) = (i == j) ? 130 : (i * 7 + j * 3) % 5;
+    }
+  }
+  S21Matrix serial_product = a * a;
+  S21Matrix serial_inverse = a.InverseMatrix();
+  double serial_determinant = a.Determinant();
+  long threshold = s21::GetParallelThreshold();
+  s21::SetNumThreads(3);
+  s21::SetParallelThreshold(1);
+  S21Matrix sum = a + a;
+  S21Matrix scaled = a * 2.0;
+  ASSERT_TRUE(sum == scaled);
+  ASSERT_TRUE(a.Transpose().Transpose() == a);
+  ASSERT_TRUE(a * a == serial_product);
+  ASSERT_TRUE(a.InverseMatrix() == serial_inverse);
+  ASSERT_NEAR(a.Determinant() / serial_determinant, 1, 1e-12);
+  s21::SetParallelThreshold(threshold);
+  s21::SetNumThreads(1);
+}
+
+TEST(Test_34, FusedExpression) {
+  S21Matrix a(3, 4);
+  S21Matrix b(3, 4);
+  S21Matrix c(3, 4);
+  for (int i = 0; i < a.GetRows(); i++) {
+    for (int j = 0; j < a.GetCols(); j++) {
+      a(i, j) = i + j;
+      b(i, j) = i * j;
+      c(i, j) = 1;
+    }
+  }
+  S21Matrix r = a + b * 2.0 - c;
+  for (int i = 0; i < r.GetRows(); i++) {
+    for (int j = 0; j < r.GetCols(); j++) {
+      ASSERT_TRUE(r(i, j) == i + j + 2.0 * i * j - 1);
+    }
+  }
+  a = a + 0.5 * a;
+  ASSERT_TRUE(a(2, 3) == 7.5);
+  S21Matrix d;
+  d = b - c;
+  ASSERT_TRUE(d.GetRows() == 3 && d.GetCols() == 4);
+  ASSERT_TRUE(d(2, 3) == 5);
+  S21Matrix wrong(4, 3);
+  EXPECT_THROW(a + b - wrong, std::invalid_argument);
+  EXPECT_THROW(a * 2.0 + wrong, std::invalid_argument);
+}
+
+TEST(Test_35, ExpressionProduct) {
+  S21Matrix a(2, 2);
+  S21Matrix b(2, 2);
+  a(0, 0) = 1;
+  a(1, 1) = 1;
+  b(0, 1) = 2;
+  b(1, 0) = 3;
+  S21Matrix expected = (a + b) * b;
+  S21Matrix sum = a + b;
+  ASSERT_TRUE(expected == sum * b);
+  ASSERT_TRUE(a * (b * 2.0) == b * 2.0);
+  ASSERT_TRUE((a * 2.0) * (b * 0.5) == b);
+}
+
+TEST(Test_36, CompoundChaining) {
+  S21Matrix a(2, 2);
+  S21Matrix b(2, 2);
+  a(0, 0) = 1;
+  b(0, 0) = 2;
+  ((a += b) -= b * 0.5) *= 4;
+  ASSERT_TRUE(a(0, 0) == 8);
+  (a *= b) += b;
+  ASSERT_TRUE(a(0, 0) == 18);
+  S21Matrix wrong(3, 2);
+  EXPECT_THROW(a += wrong, std::invalid_argument);
+  EXPECT_THROW(a -= wrong, std::invalid_argument);
+  EXPECT_THROW(a *= wrong, std::invalid_argument);
+}
+
+#ifdef S21_MATRIX_COUNT_ALLOCATIONS
+TEST(Test_37, CompoundNoAllocations) {
+  S21Matrix a(64, 64);
+  S21Matrix b(64, 64);
+  for (int i = 0; i < a.GetRows(); i++) {
+    b(i, i) = 1;
+  }
+  a *= b;
+  long before = S21Matrix::GetAllocationCount();
+  for (int step = 0; step < 100; step++) {
+    a += b;
+    a -= b * 0.5;
+    a *= 0.5;
+    a *= b;
+    a += b + b;
+    ASSERT_TRUE(a == a);
+  }
+  ASSERT_TRUE(S21Matrix::GetAllocationCount() == before);
+}
+#endif
+
+TEST(Test_38, ArenaResource) {
+  s21::ArenaResource arena(256);
+  S21Matrix outside(2, 2);
+  {
+    S21Matrix a(3, 3, &arena);
+    S21Matrix b(40, 40, &arena);
+    ASSERT_TRUE(a.GetResource() == &arena);
+    ASSERT_TRUE(arena.GetUsed() >= sizeof(double) * (3 * 8 + 40 * 40));
+    a(2, 2) = 7;
+    b(39, 39) = 1;
+    a.SetRows(5);
+    ASSERT_TRUE(a(2, 2) == 7);
+    S21Matrix copy = a;
+    ASSERT_TRUE(copy.GetResource() == std::pmr::get_default_resource());
+    S21Matrix moved = std::move(b);
+    ASSERT_TRUE(moved.GetResource() == &arena);
+    ASSERT_TRUE(moved(39, 39) == 1);
+    // Assignment keeps the resource of the target, like std::pmr
+    size_t used = arena.GetUsed();
+    S21Matrix small(4, 5);
+    small(3, 4) = 2;
+    moved = small;
+    ASSERT_TRUE(moved.GetResource() == &arena);
+    ASSERT_TRUE(moved == small);
+    ASSERT_TRUE(arena.GetUsed() == used);
+    moved = S21Matrix(50, 3);
+    ASSERT_TRUE(moved.GetResource() == &arena);
+    ASSERT_TRUE(arena.GetUsed() > used);
+    outside = std::move(a);
+    ASSERT_TRUE(outside.GetResource() == std::pmr::get_default_resource());
+  }
+  arena.Reset();
+  ASSERT_TRUE(arena.GetUsed() == 0);
+  ASSERT_TRUE(outside(2, 2) == 7);
+  S21Matrix c(2, 2, &arena);
+  ASSERT_TRUE(c(1, 1) == 0);
+}
+
+TEST(Test_39, PoolResource) {
+  s21::PoolResource* pool = s21::PoolResource::Instance();
+  for (int step = 0; step < 10; step++) {
+    S21Matrix a(4, 4, pool);
+    S21Matrix b(4, 4, pool);
+    a(1, 1) = step;
+    b(1, 1) = 1;
+    a += b;
+    ASSERT_TRUE(a(1, 1) == step + 1);
+    S21Matrix large(300, 600, pool);
+    ASSERT_TRUE(large(299, 599) == 0);
+  }
+  ASSERT_TRUE(pool->is_equal(s21::PoolResource()));
+  // Freeing many 512 KiB blocks keeps only a few MiB in the thread cache
+  {
+    std::vector<S21Matrix> blocks;
+    for (int i = 0; i < 32; i++) blocks.emplace_back(256, 256, pool);
+  }
+  ASSERT_GT(s21::PoolResource::GetCachedBytes(), 0u);
+  ASSERT_LE(s21::PoolResource::GetCachedBytes(), 4u << 20);
+}
+
+TEST(Test_40, FixedMatrixAlgebra) {
+  for (int n = 1; n <= 5; n++) {
+    S21Matrix dynamic(n, n);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        dynamic(i, j) = (i == j) ? 7 : (i * 5 + j * 3) % 4 - 1;
+      }
+    }
+    double determinant = 0;
+    S21Matrix inverse;
+    if (n == 1) {
+      S21FixedMatrix<1, 1> a(dynamic);
+      determinant = a.Determinant();
+      inverse = static_cast<S21Matrix>(a.InverseMatrix());
+    } else if (n == 2) {
+      S21FixedMatrix<2, 2> a(dynamic);
+      determinant = a.Determinant();
+      inverse = static_cast<S21Matrix>(a.InverseMatrix());
+    } else if (n == 3) {
+      S21FixedMatrix<3, 3> a(dynamic);
+      determinant = a.Determinant();
+      inverse = static_cast<S21Matrix>(a.InverseMatrix());
+    } else if (n == 4) {
+      S21FixedMatrix<4, 4> a(dynamic);
+      determinant = a.Determinant();
+      inverse = static_cast<S21Matrix>(a.InverseMatrix());
+    } else {
+      S21FixedMatrix<5, 5> a(dynamic);
+      determinant = a.Determinant();
+      inverse = static_cast<S21Matrix>(a.InverseMatrix());
+    }
+    ASSERT_NEAR(determinant, dynamic.Determinant(), 1e-9);
+    ASSERT_TRUE(inverse == dynamic.InverseMatrix());
+  }
+  S21FixedMatrix<2, 2> singular;
+  EXPECT_THROW(singular.InverseMatrix(), std::invalid_argument);
+  S21Matrix wrong(2, 3);
+  EXPECT_THROW((S21FixedMatrix<2, 2>(wrong)), std::invalid_argument);
+}
+
+TEST(Test_41, FixedMatrixArithmetic) {
+  constexpr S21FixedMatrix<2, 3> a = [] {
+    S21FixedMatrix<2, 3> result;
+    for (int i = 0; i < 2; i++) {
+      for (int j = 0; j < 3; j++) {
+        result(i, j) = i + j;
+      }
+    }
+    return result;
+  }();
+  constexpr S21FixedMatrix<3, 2> t = a.Transpose();
+  constexpr S21FixedMatrix<2, 2> product = a * t;
+  static_assert(product(1, 1) == 1 + 4 + 9, "compile-time product");
+  S21Matrix dynamic = static_cast<S21Matrix>(a) * static_cast<S21Matrix>(t);
+  ASSERT_TRUE((S21FixedMatrix<2, 2>(dynamic) == product));
+  S21FixedMatrix<2, 3> b = a * 2.0 - a;
+  b += a;
+  b -= 0.5 * a;
+  b *= 2;
+  ASSERT_TRUE(b == a * 3.0);
+  ASSERT_THROW(b(2, 0), std::out_of_range);
+}
+
+TEST(Test_42, FloatMatrix) {
+  S21MatrixF a(3, 3);
+  S21MatrixF b(3, 3);
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      a(i, j) = (i == j) ? 4.0f : 0.5f * (i + j);
+      b(i, j) = 0.25f * (i - j);
+    }
+  }
+  S21MatrixF sum = a + b * 2.0f;
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      ASSERT_FLOAT_EQ(sum(i, j), a(i, j) + 0.5f * (i - j));
+    }
+  }
+  S21MatrixF identity = a * a.InverseMatrix();
+  S21MatrixF expected(3, 3);
+  for (int i = 0; i < 3; i++) {
+    expected(i, i) = 1;
+  }
+  ASSERT_TRUE(identity == expected);
+  S21LUF lu(a);
+  ASSERT_NEAR(lu.Determinant(), a.Determinant(), 1e-4);
+  ASSERT_NEAR(a.Determinant(), 51.5f, 1e-4);
+}
+
+TEST(Test_43, FloatMulMatrix) {
+  // Small integers are exact in float, so the blocked product must match
+  // the naive one exactly
+  S21MatrixF a(70, 301);
+  S21MatrixF b(301, 45);
+  for (int i = 0; i < 70; i++) {
+    for (int j = 0; j < 301; j++) {
+      a(i, j) = (i * 7 + j * 3) % 5 - 2;
+    }
+  }
+  for (int i = 0; i < 301; i++) {
+    for (int j = 0; j < 45; j++) {
+      b(i, j) = (i * 2 + j * 5) % 7 - 3;
+    }
+  }
+  S21MatrixF product = a * b;
+  for (int i = 0; i < 70; i++) {
+    for (int j = 0; j < 45; j++) {
+      float expected = 0;
+      for (int k = 0; k < 301; k++) {
+        expected += a(i, k) * b(k, j);
+      }
+      ASSERT_EQ(product(i, j), expected);
+    }
+  }
+}
+
+TEST(Test_44, MixedPrecisionMulMatrix) {
+  int n = 200;
+  S21MatrixF a(n, n);
+  S21MatrixF b(n, n);
+  S21Matrix a_wide(n, n);
+  S21Matrix b_wide(n, n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      a(i, j) = 1.0f / (i + j + 1);
+      b(i, j) = 1.0f / (i * 3 + j + 7);
+      a_wide(i, j) = a(i, j);
+      b_wide(i, j) = b(i, j);
+    }
+  }
+  S21Matrix mixed = a.MulMatrixMixed(b);
+  S21Matrix wide = a_wide * b_wide;
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      ASSERT_NEAR(mixed(i, j), wide(i, j), 1e-12);
+    }
+  }
+  S21MatrixF wrong(n + 1, n);
+  EXPECT_THROW(a.MulMatrixMixed(wrong), std::invalid_argument);
+}
+
+TEST(Test_45, FixedMatrixFloat) {
+  S21FixedMatrix<2, 2, float> a;
+  a(0, 0) = 3;
+  a(0, 1) = 1;
+  a(1, 0) = 4;
+  a(1, 1) = 2;
+  ASSERT_FLOAT_EQ(a.Determinant(), 2.0f);
+  S21MatrixF dynamic = static_cast<S21MatrixF>(a.InverseMatrix());
+  ASSERT_TRUE(dynamic == static_cast<S21MatrixF>(a).InverseMatrix());
+  ASSERT_TRUE((0.5f * a * 2.0f == a));
+}
+
+TEST(Test_46, BlockedTranspose) {
+  for (int rows : {1, 3, 8, 37, 129}) {
+    for (int cols : {1, 5, 16, 70}) {
+      S21Matrix a(rows, cols);
+      S21MatrixF b(rows, cols);
+      for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+          a(i, j) = i * 1000 + j;
+          b(i, j) = i * 1000 + j;
+        }
+      }
+      S21Matrix at = a.Transpose();
+      S21MatrixF bt = b.Transpose();
+      ASSERT_EQ(at.GetRows(), cols);
+      ASSERT_EQ(at.GetCols(), rows);
+      for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+          ASSERT_EQ(at(j, i), a(i, j));
+          ASSERT_EQ(bt(j, i), b(i, j));
+        }
+      }
+      a.TransposeInPlace();
+      ASSERT_TRUE(a == at);
+    }
+  }
+  for (int n : {1, 2, 7, 32, 33, 100}) {
+    S21MatrixF a(n, n);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        a(i, j) = i * 1000 + j;
+      }
+    }
+    long allocations = S21Matrix::GetAllocationCount();
+    a.TransposeInPlace();
+    ASSERT_EQ(S21Matrix::GetAllocationCount(), allocations);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        ASSERT_EQ(a(j, i), i * 1000 + j);
+      }
+    }
+  }
+}
+
+TEST(Test_47, TransposedView) {
+  S21Matrix a(90, 40);
+  S21Matrix b(90, 70);
+  for (int i = 0; i < 90; i++) {
+    for (int j = 0; j < 40; j++) {
+      a(i, j) = (i * 3 + j * 7) % 11 - 5;
+    }
+    for (int j = 0; j < 70; j++) {
+      b(i, j) = (i * 5 + j * 2) % 9 - 4;
+    }
+  }
+  S21Matrix at = a.Transpose();
+  S21Matrix bt = b.Transpose();
+  ASSERT_EQ(a.TransposedView().GetRows(), 40);
+  ASSERT_TRUE(a.TransposedView() * b == at * b);
+  ASSERT_TRUE(at * b.TransposedView().GetMatrix() == at * b);
+  ASSERT_TRUE(bt * a == b.TransposedView() * a);
+  ASSERT_TRUE(a.TransposedView() * bt.TransposedView() == at * b);
+  ASSERT_TRUE(bt * bt.TransposedView() == bt * b);
+  S21Matrix c = at;
+  c *= bt.TransposedView();
+  ASSERT_TRUE(c == at * b);
+  S21Matrix square = at * a;
+  S21Matrix expected = square * square.Transpose();
+  square *= square.TransposedView();
+  ASSERT_TRUE(square == expected);
+  // Reading the transpose of the matrix being assigned
+  S21Matrix sym = at * a;
+  S21Matrix sum = sym + sym.Transpose();
+  sym = sym + sym.TransposedView();
+  ASSERT_TRUE(sym == sum);
+  sym -= sym.TransposedView();
+  ASSERT_TRUE(sym == S21Matrix(40, 40));
+  EXPECT_THROW(a * b.TransposedView(), std::invalid_argument);
+  EXPECT_THROW(a.TransposedView() * a.TransposedView(),
+               std::invalid_argument);
+  EXPECT_THROW(a.MulMatrix(b.TransposedView()), std::invalid_argument);
+}
+
+TEST(Test_48, MatrixView) {
+  S21Matrix a(6, 8);
+  for (int i = 0; i < 6; i++) {
+    for (int j = 0; j < 8; j++) {
+      a(i, j) = i * 10 + j;
+    }
+  }
+  S21MatrixView block = a.View(1, 2, 3, 4);
+  ASSERT_EQ(block.GetRows(), 3);
+  ASSERT_EQ(block.GetCols(), 4);
+  ASSERT_EQ(block(0, 0), 12);
+  ASSERT_EQ(block(2, 3), 35);
+  block(1, 1) = -1;
+  ASSERT_EQ(a(2, 3), -1);
+  S21MatrixView strided = a.View(0, 1, 3, 4, 2, 2);
+  ASSERT_EQ(strided(1, 0), 21);
+  ASSERT_EQ(strided(2, 3), 47);
+  S21MatrixView inner = strided.View(1, 1, 2, 2);
+  ASSERT_EQ(inner(1, 1), 45);
+  const S21Matrix& constant = a;
+  S21BasicMatrixView<const double> read_only = constant.View(1, 2, 3, 4);
+  S21BasicMatrixView<const double> converted = block;
+  ASSERT_TRUE(read_only == converted);
+  S21Matrix copy = read_only;
+  ASSERT_EQ(copy.GetRows(), 3);
+  ASSERT_EQ(copy(1, 1), -1);
+  EXPECT_THROW(a.View(4, 0, 3, 1), std::out_of_range);
+  EXPECT_THROW(a.View(0, 0, 4, 1, 2, 1), std::out_of_range);
+  EXPECT_THROW(a.View(-1, 0, 1, 1), std::out_of_range);
+  EXPECT_THROW(a.View(0, 0, 0, 1), std::invalid_argument);
+  EXPECT_THROW(a.View(0, 0, 1, 1, 0, 1), std::invalid_argument);
+  EXPECT_THROW(block(3, 0), std::out_of_range);
+}
+
+TEST(Test_49, MatrixViewArithmetic) {
+  S21Matrix a(8, 8);
+  for (int i = 0; i < 8; i++) {
+    for (int j = 0; j < 8; j++) {
+      a(i, j) = (i * 5 + j * 3) % 7 + (i == j ? 10 : 0);
+    }
+  }
+  S21Matrix snapshot = a;
+  // Overlapping source and destination inside one buffer
+  a.View(0, 0, 6, 6) = a.View(2, 2, 6, 6);
+  ASSERT_TRUE(a.View(0, 0, 6, 6) == snapshot.View(2, 2, 6, 6));
+  a = snapshot;
+  a.View(0, 0, 4, 4) += a.View(4, 4, 4, 4) * 2.0;
+  a.View(4, 4, 4, 4).MulNumber(0.5);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      ASSERT_EQ(a(i, j), snapshot(i, j) + 2 * snapshot(i + 4, j + 4));
+      ASSERT_EQ(a(i + 4, j + 4), snapshot(i + 4, j + 4) / 2);
+      ASSERT_EQ(a(i, j + 4), snapshot(i, j + 4));
+    }
+  }
+  a = snapshot;
+  S21Matrix top = snapshot.View(0, 0, 3, 8);
+  S21Matrix left = snapshot.View(0, 0, 8, 3);
+  S21Matrix even = snapshot.View(0, 0, 4, 8, 2, 1);
+  ASSERT_TRUE(a.View(0, 0, 3, 8) * a.View(0, 0, 8, 3) == top * left);
+  ASSERT_TRUE(a * a.View(0, 0, 8, 3) == a * left);
+  ASSERT_TRUE(a.View(0, 0, 4, 8, 2, 1) * a == even * a);
+  S21Matrix product = top;
+  product.MulMatrix(a.View(0, 0, 8, 3));
+  ASSERT_TRUE(product == top * left);
+  product = top;
+  product += a.View(0, 0, 3, 8);
+  product.SubMatrix(a.View(0, 0, 3, 8));
+  ASSERT_TRUE(product.EqMatrix(a.View(0, 0, 3, 8)));
+  S21Matrix square = snapshot.View(2, 1, 5, 5);
+  ASSERT_NEAR(a.View(2, 1, 5, 5).Determinant(), square.Determinant(), 1e-6);
+  ASSERT_TRUE(a.View(2, 1, 5, 5).InverseMatrix() == square.InverseMatrix());
+  S21LU lu(a.View(2, 1, 5, 5));
+  ASSERT_NEAR(lu.Determinant(), square.Determinant(), 1e-6);
+  ASSERT_TRUE(a == snapshot);
+  EXPECT_THROW(a.View(0, 0, 2, 2) = a.View(0, 0, 3, 3),
+               std::invalid_argument);
+  EXPECT_THROW(a.View(0, 0, 2, 3).Determinant(), std::invalid_argument);
+}
+
+TEST(Test_50, CalcComplementsRank) {
+  // Cofactors straight from the definition, as the reference
+  auto cofactors = [](S21Matrix& a) {
+    int n = a.GetRows();
+    S21Matrix result(n, n);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        S21Matrix minor(n - 1, n - 1);
+        for (int r = 0, mr = 0; r < n; r++) {
+          for (int s = 0, ms = 0; s < n && r != i; s++) {
+            if (s != j) {
+              minor(mr, ms++) = a(r, s);
+            }
+          }
+          mr += (r != i);
+        }
+        result(i, j) = ((i + j) % 2 ? -1 : 1) * minor.Determinant();
+      }
+    }
+    return result;
+  };
+  for (int n = 2; n <= 7; n++) {
+    for (int rank = n; rank >= n - 2 && rank > 0; rank--) {
+      // Product of n x rank and rank x n integer matrices has that rank
+      S21Matrix left(n, rank);
+      S21Matrix right(rank, n);
+      for (int i = 0; i < n; i++) {
+        for (int k = 0; k < rank; k++) {
+          left(i, k) = (i * 7 + k * 3 + n) % 5 - 2 + (i == k ? 3 : 0);
+          right(k, i) = (i * 2 + k * 5 + n) % 7 - 3 + (i == k ? 4 : 0);
+        }
+      }
+      S21Matrix a = left * right;
+      S21Matrix expected = cofactors(a);
+      S21Matrix result = a.CalcComplements();
+      for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+          ASSERT_NEAR(result(i, j), expected(i, j),
+                      1e-9 * (1 + fabs(expected(i, j))))
+              << "n " << n << " rank " << rank;
+        }
+      }
+    }
+  }
+  S21Matrix zero(3, 3);
+  ASSERT_TRUE(zero.CalcComplements() == zero);
+  // Badly scaled: full rank, then rank 2
+  S21Matrix scaled(3, 3);
+  scaled(0, 0) = 1e8;
+  scaled(1, 1) = 1e-8;
+  scaled(2, 2) = 1;
+  S21Matrix complements = scaled.CalcComplements();
+  ASSERT_DOUBLE_EQ(complements(0, 0), 1e-8);
+  ASSERT_DOUBLE_EQ(complements(1, 1), 1e8);
+  ASSERT_DOUBLE_EQ(complements(2, 2), 1);
+  scaled(2, 2) = 0;
+  complements = scaled.CalcComplements();
+  ASSERT_DOUBLE_EQ(complements(2, 2), 1);
+  ASSERT_DOUBLE_EQ(complements(1, 1), 0);
+}
+
+TEST(Test_51, CalcComplementsLarge) {
+  int n = 120;
+  S21Matrix a(n, n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      a(i, j) = (i == j) ? 1.5 : 0.5 / (i + j + 1);
+    }
+  }
+  // A^T * C = det(A) * I, by the definition of the adjugate
+  S21Matrix complements = a.CalcComplements();
+  double det = a.Determinant();
+  S21Matrix check = a.TransposedView() * complements;
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      ASSERT_NEAR(check(i, j) / det, i == j ? 1 : 0, 1e-9);
+    }
+  }
+}
+
+TEST(Test_52, SparseMatrix) {
+  S21Matrix dense(5, 7);
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 7; j++) {
+      if ((i * 7 + j) % 4 == 0) {
+        dense(i, j) = i - j + 0.5;
+      }
+    }
+  }
+  using Format = S21SparseMatrix::Format;
+  S21SparseMatrix csr(dense);
+  S21SparseMatrix csc(dense, Format::kCsc);
+  ASSERT_EQ(csr.GetNonZeros(), 9);
+  ASSERT_EQ(csc.GetNonZeros(), 9);
+  ASSERT_EQ(csr.GetOffsets().size(), 6u);
+  ASSERT_EQ(csc.GetOffsets().size(), 8u);
+  ASSERT_TRUE(csr.ToDense() == dense);
+  ASSERT_TRUE(csc.ToDense() == dense);
+  ASSERT_TRUE(csr == csc);
+  ASSERT_TRUE(csc.ToFormat(Format::kCsr).GetIndices() == csr.GetIndices());
+  ASSERT_EQ(csr(4, 0), 4.5);
+  ASSERT_EQ(csc(4, 0), 4.5);
+  ASSERT_EQ(csr(4, 1), 0);
+  ASSERT_TRUE(csr.Transpose().ToDense() == dense.Transpose());
+  ASSERT_EQ(csr.Transpose().GetFormat(), Format::kCsc);
+  S21SparseMatrix built(
+      5, 7, {{4, 0, 4.0}, {0, 0, 0.5}, {4, 0, 0.5}, {1, 3, -1.5}});
+  ASSERT_EQ(built.GetNonZeros(), 3);
+  ASSERT_EQ(built(4, 0), 4.5);
+  ASSERT_EQ(built(1, 3), -1.5);
+  S21SparseMatrix sum = csr + built;
+  ASSERT_TRUE(sum.ToDense() == dense + built.ToDense());
+  sum -= csc;
+  ASSERT_TRUE(sum == built);
+  sum *= 2;
+  ASSERT_TRUE((sum * 0.5).ToDense() == built.ToDense());
+  EXPECT_THROW(csr(5, 0), std::out_of_range);
+  EXPECT_THROW(S21SparseMatrix(2, 2, {{2, 0, 1.0}}), std::out_of_range);
+  EXPECT_THROW(csr + S21SparseMatrix(7, 5), std::invalid_argument);
+  EXPECT_THROW(S21SparseMatrix(0, 5), std::invalid_argument);
+}
+
+TEST(Test_53, SparseProducts) {
+  int m = 60;
+  int k = 45;
+  int n = 30;
+  S21Matrix a(m, k);
+  S21Matrix b(k, n);
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < k; j++) {
+      a(i, j) = (i * 13 + j * 7) % 11 == 0 ? (i + j) % 5 - 2 : 0;
+    }
+  }
+  for (int i = 0; i < k; i++) {
+    for (int j = 0; j < n; j++) {
+      b(i, j) = (i * 5 + j * 3) % 9 == 0 ? (i - j) % 4 + 1 : 0;
+    }
+  }
+  S21Matrix expected = a * b;
+  using Format = S21SparseMatrix::Format;
+  for (Format format : {Format::kCsr, Format::kCsc}) {
+    S21SparseMatrix sa(a, format);
+    S21SparseMatrix sb(b, format);
+    S21SparseMatrix product = sa * sb;
+    ASSERT_EQ(product.GetFormat(), format);
+    ASSERT_TRUE(product.ToDense() == expected);
+    ASSERT_TRUE((sa * S21SparseMatrix(b)).ToDense() == expected);
+    ASSERT_TRUE(sa * b == expected);
+    ASSERT_TRUE(a * sb == expected);
+    std::vector<double> x(k);
+    for (int j = 0; j < k; j++) {
+      x[j] = j * 0.25 - 3;
+    }
+    std::vector<double> y = sa * x;
+    for (int i = 0; i < m; i++) {
+      double sum = 0;
+      for (int j = 0; j < k; j++) {
+        sum += a(i, j) * x[j];
+      }
+      ASSERT_DOUBLE_EQ(y[i], sum);
+    }
+    EXPECT_THROW(sa * sa, std::invalid_argument);
+    EXPECT_THROW(sa * a, std::invalid_argument);
+    EXPECT_THROW(b * sa, std::invalid_argument);
+    EXPECT_THROW(sa * std::vector<double>(m), std::invalid_argument);
+  }
+}
+
+TEST(Test_54, SaveLoad) {
+  std::string path = ::testing::TempDir() + "s21_test_54.bin";
+  S21Matrix a(7, 13);
+  S21MatrixF f(5, 3);
+  for (int i = 0; i < 7; i++) {
+    for (int j = 0; j < 13; j++) {
+      a(i, j) = i * 0.5 - j * 1.25;
+      if (i < 5 && j < 3) f(i, j) = i * j - 2.5f;
+    }
+  }
+  a.Save(path);
+  S21Matrix loaded = S21Matrix::Load(path);
+  ASSERT_EQ(loaded.GetRows(), 7);
+  ASSERT_EQ(loaded.GetCols(), 13);
+  ASSERT_TRUE(loaded == a);
+  ASSERT_THROW(S21MatrixF::Load(path), std::invalid_argument);
+  f.Save(path);
+  ASSERT_TRUE(S21MatrixF::Load(path) == f);
+  ASSERT_THROW(S21Matrix::Load(path), std::invalid_argument);
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "not a matrix file, but long enough to hold a whole header ....";
+  }
+  ASSERT_THROW(S21Matrix::Load(path), std::invalid_argument);
+  // Another writer left garbage in the padding of the native stride
+  S21MatrixFileHeader header = {};
+  memcpy(header.magic, S21MatrixFileHeader::kMagic, sizeof(header.magic));
+  header.version = S21MatrixFileHeader::kVersion;
+  header.byte_order = S21MatrixFileHeader::kByteOrder;
+  header.scalar_size = sizeof(double);
+  header.rows = 2;
+  header.cols = 3;
+  header.stride = 8;
+  header.payload_offset = sizeof(header);
+  std::vector<double> payload(16, 7.0);
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(payload.data()),
+               sizeof(double) * payload.size());
+  }
+  S21Matrix padded = S21Matrix::Load(path);
+  ASSERT_EQ(padded(1, 2), 7.0);
+  padded.Save(path);
+  {
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(sizeof(header));
+    file.read(reinterpret_cast<char*>(payload.data()),
+              sizeof(double) * payload.size());
+  }
+  for (int i = 0; i < 16; i++) {
+    ASSERT_EQ(payload[i], i % 8 < 3 ? 7.0 : 0.0);
+  }
+  // A header asking for far more than the file holds allocates nothing
+  header.rows = 1 << 30;
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+  long before = S21Matrix::GetAllocationCount();
+  ASSERT_THROW(S21Matrix::Load(path), std::invalid_argument);
+  ASSERT_EQ(S21Matrix::GetAllocationCount(), before);
+  std::remove(path.c_str());
+  ASSERT_THROW(S21Matrix::Load(path), std::runtime_error);
+}
+
+TEST(Test_55, MapFile) {
+  std::string path = ::testing::TempDir() + "s21_test_55.bin";
+  S21Matrix a(9, 9);
+  for (int i = 0; i < 9; i++) {
+    for (int j = 0; j < 9; j++) {
+      a(i, j) = (i == j) * 10 + (i * 7 + j * 3) % 5 - 2;
+    }
+  }
+  a.Save(path);
+  S21MappedMatrix mapped = S21Matrix::MapFile(path);
+  ASSERT_EQ(mapped.GetRows(), 9);
+  ASSERT_EQ(mapped.GetCols(), 9);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(mapped.Data()) % 64, 0u);
+  ASSERT_TRUE(mapped == a);
+  ASSERT_TRUE(mapped * a == a * a);
+  ASSERT_NEAR(mapped.Determinant(), a.Determinant(), 1e-6);
+  ASSERT_TRUE(mapped.View(2, 3, 4, 2) == a.View(2, 3, 4, 2));
+  S21MappedMatrix moved(std::move(mapped));
+  ASSERT_TRUE(moved.InverseMatrix() == a.InverseMatrix());
+  ASSERT_THROW(S21MatrixF::MapFile(path), std::invalid_argument);
+  ASSERT_EQ(truncate(path.c_str(), 64 + 8 * 9), 0);
+  ASSERT_THROW(S21Matrix::MapFile(path), std::invalid_argument);
+  ASSERT_THROW(S21Matrix::Load(path), std::invalid_argument);
+  std::remove(path.c_str());
+  ASSERT_THROW(S21Matrix::MapFile(path), std::runtime_error);
+}
+
+TEST(Test_56, MulFiles) {
+  std::string a_path = ::testing::TempDir() + "s21_test_56_a.bin";
+  std::string b_path = ::testing::TempDir() + "s21_test_56_b.bin";
+  std::string c_path = ::testing::TempDir() + "s21_test_56_c.bin";
+  S21Matrix a(37, 23);
+  S21Matrix b(23, 29);
+  for (int i = 0; i < 37; i++) {
+    for (int j = 0; j < 23; j++) a(i, j) = (i * 7 + j * 3) % 11 - 5;
+  }
+  for (int i = 0; i < 23; i++) {
+    for (int j = 0; j < 29; j++) b(i, j) = (i * 5 + j * 2) % 9 - 4;
+  }
+  a.Save(a_path);
+  b.Save(b_path);
+  // 8x8 tiles, 5x6 partial ones at the edges
+  S21Matrix::MulFiles(a_path, b_path, c_path, 5 * 8 * 8 * sizeof(double));
+  ASSERT_TRUE(S21Matrix::Load(c_path) == a * b);
+  S21Matrix::MulFiles(a_path, b_path, c_path, 1 << 20);
+  ASSERT_TRUE(S21Matrix::Load(c_path) == a * b);
+  S21MatrixF fa(37, 23);
+  S21MatrixF fb(23, 29);
+  for (int i = 0; i < 37; i++) {
+    for (int j = 0; j < 23; j++) fa(i, j) = a(i, j);
+  }
+  for (int i = 0; i < 23; i++) {
+    for (int j = 0; j < 29; j++) fb(i, j) = b(i, j);
+  }
+  fa.Save(a_path);
+  fb.Save(b_path);
+  S21MatrixF::MulFiles(a_path, b_path, c_path, 5 * 3 * 3 * sizeof(float));
+  ASSERT_TRUE(S21MatrixF::Load(c_path) == fa * fb);
+  ASSERT_THROW(S21MatrixF::MulFiles(a_path, a_path, c_path, 1 << 20),
+               std::invalid_argument);
+  ASSERT_THROW(S21MatrixF::MulFiles(a_path, b_path, c_path, 8),
+               std::invalid_argument);
+  ASSERT_THROW(S21MatrixF::MulFiles(a_path, b_path, a_path, 1 << 20),
+               std::invalid_argument);
+  ASSERT_THROW(S21Matrix::MulFiles(a_path, b_path, c_path, 1 << 20),
+               std::invalid_argument);
+  std::remove(a_path.c_str());
+  std::remove(b_path.c_str());
+  std::remove(c_path.c_str());
+}
+
+TEST(Test_57, MatrixBatch) {
+  int count = 37;
+  S21MatrixBatch a(count, 4, 4);
+  S21MatrixBatch b(count, 4, 3);
+  for (int m = 0; m < count; m++) {
+    for (int i = 0; i < 4; i++) {
+      for (int j = 0; j < 4; j++) {
+        a(m, i, j) = (i == j) * (m % 5 + 4) + (i * 3 + j * 7 + m) % 6 - 2.5;
+        if (j < 3) b(m, i, j) = (i + 2 * j + m) % 5 - 1;
+      }
+    }
+  }
+  // Matrix 5 is singular: two equal rows
+  for (int j = 0; j < 4; j++) a(5, 3, j) = a(5, 1, j);
+  std::vector<double> determinants = a.Determinant();
+  ASSERT_EQ(static_cast<int>(determinants.size()), count);
+  for (int m = 0; m < count; m++) {
+    S21Matrix single = a.Get(m);
+    ASSERT_NEAR(determinants[m], single.Determinant(), 1e-9);
+    ASSERT_TRUE((a * b).Get(m) == single * b.Get(m));
+    ASSERT_TRUE(a.Transpose().Get(m) == single.Transpose());
+  }
+  ASSERT_THROW(a.InverseMatrix(), std::invalid_argument);
+  a.Set(5, a.Get(6));
+  S21MatrixBatch inverse = a.InverseMatrix();
+  for (int m = 0; m < count; m++) {
+    ASSERT_TRUE(inverse.Get(m) == a.Get(m).InverseMatrix());
+  }
+  S21MatrixBatch identity = a * inverse;
+  S21MatrixBatch expected(count, 4, 4);
+  for (int m = 0; m < count; m++) {
+    for (int i = 0; i < 4; i++) expected(m, i, i) = 1;
+  }
+  ASSERT_TRUE(identity == expected);
+  ASSERT_THROW(b * a, std::invalid_argument);
+  ASSERT_THROW(b.Determinant(), std::invalid_argument);
+  ASSERT_THROW(a * S21MatrixBatch(2, 4, 4), std::invalid_argument);
+  ASSERT_THROW(a(count, 0, 0), std::out_of_range);
+  ASSERT_THROW(a.Set(0, S21Matrix(3, 3)), std::invalid_argument);
+  // Large orders are inverted one matrix at a time
+  S21MatrixBatch large(3, 16, 16);
+  for (int m = 0; m < 3; m++) {
+    for (int i = 0; i < 16; i++) {
+      for (int j = 0; j < 16; j++) {
+        large(m, i, j) = (i * 5 + j * 11 + m) % 9 - 4 + (i == j) * (m + 20);
+      }
+    }
+  }
+  S21MatrixBatch large_inverse = large.InverseMatrix();
+  for (int m = 0; m < 3; m++) {
+    ASSERT_TRUE(large_inverse.Get(m) == large.Get(m).InverseMatrix());
+  }
+  for (int j = 0; j < 16; j++) large(2, 7, j) = large(2, 3, j);
+  ASSERT_THROW(large.InverseMatrix(), std::invalid_argument);
+  // Hilbert matrices around the condition limit fail or pass as a batch
+  // exactly as they do one by one
+  auto message = [](auto invert) {
+    try {
+      invert();
+    } catch (const std::invalid_argument& error) {
+      return std::string(error.what());
+    }
+    return std::string();
+  };
+  for (int n = 9; n <= 14; n++) {
+    S21MatrixBatch hilbert(3, n, n);
+    for (int i = 0; i < n; i++) {
+      hilbert(0, i, i) = hilbert(2, i, i) = 1;
+      for (int j = 0; j < n; j++) hilbert(1, i, j) = 1.0 / (i + j + 1);
+    }
+    std::string single = message([&] { hilbert.Get(1).InverseMatrix(); });
+    ASSERT_EQ(message([&] { hilbert.InverseMatrix(); }), single) << n;
+    if (single.empty()) {
+      S21Matrix inverse = hilbert.InverseMatrix().Get(1);
+      S21Matrix expected = hilbert.Get(1).InverseMatrix();
+      double scale = 0;
+      for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) scale = fmax(scale, fabs(expected(i, j)));
+      }
+      for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+          ASSERT_NEAR(inverse(i, j), expected(i, j), 1e-3 * scale);
+        }
+      }
+    }
+  }
+  S21MatrixBatchF f(3, 2, 2);
+  f(0, 0, 0) = f(1, 1, 1) = 2;
+  f(0, 1, 1) = f(1, 0, 0) = 3;
+  f(2, 0, 1) = f(2, 1, 0) = 1;
+  std::vector<float> f_determinants = f.Determinant();
+  ASSERT_FLOAT_EQ(f_determinants[0], 6);
+  ASSERT_FLOAT_EQ(f_determinants[1], 6);
+  ASSERT_FLOAT_EQ(f_determinants[2], -1);
+}
+
+TEST(Test_58, Solve) {
+  int n = 40;
+  S21Matrix a(n, n);
+  S21Matrix b(n, 3);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      a(i, j) = (i * 17 + j * 29) % 13 - 6 + (i == j) * 3;
+    }
+    for (int j = 0; j < 3; j++) b(i, j) = (i + 1) * (j - 1);
+  }
+  S21Matrix x = a.Solve(b);
+  ASSERT_EQ(x.GetRows(), n);
+  ASSERT_EQ(x.GetCols(), 3);
+  ASSERT_TRUE(a * x == b);
+  ASSERT_TRUE(x == a.InverseMatrix() * b);
+  S21LU lu(a);
+  ASSERT_TRUE(lu.Solve(b) == x);
+  S21Matrix column(n, 1);
+  column(7, 0) = 1;
+  ASSERT_TRUE(a * lu.Solve(column) == column);
+  ASSERT_THROW(lu.Solve(S21Matrix(n + 1, 1)), std::invalid_argument);
+  S21Matrix singular(2, 2);
+  singular(0, 0) = singular(0, 1) = 1;
+  ASSERT_THROW(singular.Solve(S21Matrix(2, 1)), std::invalid_argument);
+  S21MatrixF f(2, 2);
+  S21MatrixF g(2, 1);
+  f(0, 0) = 2;
+  f(1, 1) = 4;
+  g(0, 0) = g(1, 0) = 1;
+  S21MatrixF solution = f.Solve(g);
+  ASSERT_FLOAT_EQ(solution(0, 0), 0.5f);
+  ASSERT_FLOAT_EQ(solution(1, 0), 0.25f);
+}
+
+TEST(Test_59, CholeskyAndQR) {
+  int n = 30;
+  S21Matrix m(n, n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) m(i, j) = (i * 7 + j * 11) % 9 - 4;
+  }
+  // M^T * M + I is symmetric positive definite
+  S21Matrix spd = m.Transpose() * m;
+  for (int i = 0; i < n; i++) spd(i, i) += 1;
+  S21Matrix b(n, 4);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < 4; j++) b(i, j) = (i % 5) - j;
+  }
+  S21Cholesky cholesky(spd);
+  S21Matrix l = cholesky.GetFactor();
+  ASSERT_TRUE(l * l.Transpose() == spd);
+  ASSERT_EQ(l(0, 1), 0);
+  ASSERT_NEAR(cholesky.Determinant() / spd.Determinant(), 1, 1e-9);
+  S21Matrix x = cholesky.Solve(b);
+  ASSERT_TRUE(spd * x == b);
+  ASSERT_TRUE(S21QR(spd).Solve(b) == x);
+  S21Matrix indefinite(2, 2);
+  indefinite(0, 0) = 1;
+  indefinite(1, 1) = -1;
+  ASSERT_THROW(S21Cholesky{indefinite}, std::invalid_argument);
+  // Line fit y = 2 + 3 t through points with zero-mean residuals
+  S21Matrix design(6, 2);
+  S21Matrix y(6, 1);
+  double noise[6] = {0.5, -0.5, -0.5, 0.5, 0.25, -0.25};
+  for (int i = 0; i < 6; i++) {
+    design(i, 0) = 1;
+    design(i, 1) = i;
+    y(i, 0) = 2 + 3 * i + noise[i];
+  }
+  S21Matrix fit = design.Solve(y);
+  S21Matrix normal =
+      (design.Transpose() * design).Solve(design.Transpose() * y);
+  ASSERT_TRUE(fit == normal);
+  S21QR qr(design);
+  ASSERT_FALSE(qr.IsRankDeficient());
+  ASSERT_TRUE(qr.Solve(y) == fit);
+  ASSERT_THROW(S21QR(design.Transpose()), std::invalid_argument);
+  S21Matrix deficient(3, 2);
+  for (int i = 0; i < 3; i++) deficient(i, 0) = deficient(i, 1) = i + 1;
+  ASSERT_TRUE(S21QR(deficient).IsRankDeficient());
+  ASSERT_THROW(deficient.Solve(y), std::invalid_argument);
+}
+
+TEST(Test_60, Profile) {
+  s21::ResetProfile();
+  S21Matrix a(30, 20);
+  S21Matrix b(20, 10);
+  S21Matrix c = a * b;
+  a.SumMatrix(a);
+  std::thread worker([] {
+    S21Matrix d(3, 3);
+    d.Transpose();
+    d.Transpose();
+  });
+  worker.join();
+  s21::ProfileSnapshot profile = s21::GetProfile();
+#ifdef S21_MATRIX_PROFILE
+  const s21::OperationStats& mul =
+      profile.operations[static_cast<int>(s21::Operation::kMulMatrix)];
+  ASSERT_EQ(mul.calls, 1u);
+  ASSERT_EQ(mul.flops, 2u * 30 * 20 * 10);
+  ASSERT_EQ(mul.bytes, 8u * (30 * 20 + 20 * 10 + 30 * 10));
+  // 30 rows fall in the bucket up to 32, 20 cols in the one up to 32
+  ASSERT_EQ(mul.shapes[5][5], 1u);
+  ASSERT_EQ(
+      profile.operations[static_cast<int>(s21::Operation::kSumMatrix)].calls,
+      1u);
+  // Counted by a thread that has exited since
+  ASSERT_EQ(
+      profile.operations[static_cast<int>(s21::Operation::kTranspose)].calls,
+      2u);
+  ASSERT_EQ(profile.allocations, 6u);
+  std::string text = s21::ToPrometheus(profile);
+  ASSERT_NE(text.find("# TYPE s21_matrix_calls_total counter"),
+            std::string::npos);
+  ASSERT_NE(text.find("s21_matrix_calls_total{op=\"mul_matrix\"} 1\n"),
+            std::string::npos);
+  ASSERT_NE(text.find("s21_matrix_shape_calls_total{op=\"transpose\","
+                      "rows=\"4\",cols=\"4\"} 2\n"),
+            std::string::npos);
+  ASSERT_NE(text.find("s21_matrix_allocations_total 6\n"), std::string::npos);
+  s21::ResetProfile();
+  profile = s21::GetProfile();
+  ASSERT_EQ(
+      profile.operations[static_cast<int>(s21::Operation::kMulMatrix)].calls,
+      0u);
+  ASSERT_EQ(profile.allocations, 0u);
+  // Declares no bytes of its own, but its operand is large: always timed
+  S21Matrix big(100, 100);
+  for (int i = 0; i < 100; i++) big(i, i) = 1;
+  for (int i = 0; i < 3; i++) big.Determinant();
+  profile = s21::GetProfile();
+  const s21::OperationStats& determinant =
+      profile.operations[static_cast<int>(s21::Operation::kDeterminant)];
+  ASSERT_EQ(determinant.calls, 3u);
+  ASSERT_GT(determinant.nanoseconds, 0u);
+  // Cheap calls are counted exactly, timed or not
+  S21Matrix small(2, 3);
+  S21Matrix other(2, 3);
+  for (int i = 0; i < 1000; i++) small.SumMatrix(other);
+  profile = s21::GetProfile();
+  const s21::OperationStats& sum =
+      profile.operations[static_cast<int>(s21::Operation::kSumMatrix)];
+  ASSERT_EQ(sum.calls, 1000u);
+  ASSERT_EQ(sum.flops, 6000u);
+  ASSERT_EQ(sum.bytes, 1000u * 3 * 8 * 6);
+  ASSERT_EQ(sum.shapes[1][2], 1000u);
+  ASSERT_GT(sum.nanoseconds, 0u);
+#else
+  ASSERT_EQ(profile.allocations, 0u);
+#endif
+}
+
+TEST(Test_61, EqMatrixModes) {
+  // 37 columns: full vector blocks, a scalar tail and padded rows
+  S21Matrix a(5, 37);
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 37; j++) {
+      a(i, j) = (i * 37 + j) * 0.25 - 20;
+    }
+  }
+  S21Matrix b = a;
+  ASSERT_TRUE(a.EqMatrix(b, S21Tolerance::Bitwise()));
+  ASSERT_EQ(a.Hash(), b.Hash());
+  for (int j : {0, 15, 16, 33, 36}) {
+    b = a;
+    b(4, j) += 1e-6;
+    ASSERT_FALSE(a == b);
+    ASSERT_FALSE(a.EqMatrix(b, S21Tolerance::Bitwise()));
+    ASSERT_TRUE(a.EqMatrix(b, S21Tolerance::Absolute(1e-5)));
+    ASSERT_NE(a.Hash(), b.Hash());
+  }
+  b = a;
+  b(3, 30) = nextafter(a(3, 30), 1e9);
+  b(3, 31) = nextafter(nextafter(a(3, 31), -1e9), -1e9);
+  ASSERT_TRUE(a.EqMatrix(b, S21Tolerance::Ulps(2)));
+  ASSERT_FALSE(a.EqMatrix(b, S21Tolerance::Ulps(1)));
+  b(3, 31) = a(3, 31) * (1 + 1e-9);
+  ASSERT_TRUE(a.EqMatrix(b, S21Tolerance::Relative(2e-9)));
+  ASSERT_FALSE(a.EqMatrix(b, S21Tolerance::Relative(1e-10)));
+  S21Matrix zeros(1, 1);
+  S21Matrix negative_zeros(1, 1);
+  negative_zeros(0, 0) = -0.0;
+  ASSERT_TRUE(zeros.EqMatrix(negative_zeros, S21Tolerance::Ulps(0)));
+  ASSERT_FALSE(zeros.EqMatrix(negative_zeros, S21Tolerance::Bitwise()));
+  ASSERT_TRUE(zeros.EqMatrix(negative_zeros, S21Tolerance::Relative(0)));
+
+  S21Matrix t = a.Transpose();
+  ASSERT_TRUE(a.EqMatrix(t.TransposedView(), S21Tolerance::Bitwise()));
+  ASSERT_TRUE(t.View(2, 1, 30, 3).EqMatrix(a.View(1, 2, 3, 30).Transpose(),
+                                           S21Tolerance::Ulps(0)));
+  ASSERT_TRUE(a.EqMatrix(a * 1.0, S21Tolerance::Bitwise()));
+  ASSERT_FALSE(a.EqMatrix(a * (1 + 1e-12), S21Tolerance::Bitwise()));
+  ASSERT_FALSE(a.EqMatrix(t, S21Tolerance::Absolute(1e9)));
+
+  S21MatrixF f(3, 40);
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 40; j++) {
+      f(i, j) = i - j * 0.5f;
+    }
+  }
+  S21MatrixF g = f;
+  g(2, 39) += 0.25f;
+  ASSERT_FALSE(f == g);
+  ASSERT_TRUE(f.EqMatrix(g, S21Tolerance::Absolute(0.3)));
+  ASSERT_NE(f.Hash(), g.Hash());
+  g = f;
+  g(1, 20) = nextafterf(f(1, 20), 100);
+  g(1, 21) = -f(1, 21);
+  ASSERT_FALSE(f.EqMatrix(g, S21Tolerance::Ulps(1)));
+  g(1, 21) = f(1, 21);
+  ASSERT_TRUE(f.EqMatrix(g, S21Tolerance::Ulps(1)));
+  ASSERT_FALSE(f.EqMatrix(g, S21Tolerance::Ulps(0)));
+  ASSERT_NE(S21Matrix(2, 3).Hash(), S21Matrix(3, 2).Hash());
+  // A write through a reference taken before Hash() leaves the memo
+  // stale; equality still follows the elements
+  b = a;
+  double& element = b(2, 7);
+  element += 1;
+  ASSERT_NE(a.Hash(), b.Hash());
+  element -= 1;
+  ASSERT_TRUE(a.EqMatrix(b, S21Tolerance::Bitwise()));
+  // Reference value of XXH64 for an empty input and seed 0
+  ASSERT_EQ(s21::Hash(nullptr, 0, 0), 0xEF46DB3751D8E999ULL);
+}
+
+TEST(Test_62, ResultCache) {
+  S21Matrix a(4, 4);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      a(i, j) = (i == j) * 8 + (i * 5 + j * 3) % 7 - 3;
+    }
+  }
+  uint64_t hash = a.Hash();
+  ASSERT_EQ(a.Hash(), hash);
+  a(1, 2) += 1;
+  ASSERT_NE(a.Hash(), hash);
+  a(1, 2) -= 1;
+  ASSERT_EQ(a.Hash(), hash);
+
+  S21ResultCache cache(1 << 20);
+  S21Matrix::SetResultCache(&cache);
+  double determinant = a.Determinant();
+  ASSERT_DOUBLE_EQ(a.Determinant(), determinant);
+  ASSERT_EQ(cache.GetMisses(), 1);
+  ASSERT_EQ(cache.GetHits(), 1);
+  S21Matrix b = a;
+  ASSERT_TRUE(b.InverseMatrix() == a.InverseMatrix());
+  ASSERT_TRUE(b.CalcComplements() == a.CalcComplements());
+  ASSERT_EQ(cache.GetHits(), 3);
+  ASSERT_EQ(cache.GetUsed(), 8u * (17 + 32 + 32));
+
+  // Each kind of modification leads to a fresh result
+  a(0, 0) += 1;
+  ASSERT_NEAR(a.Determinant(), S21LU(a).Determinant(), 1e-9);
+  a += b;
+  ASSERT_NEAR(a.Determinant(), S21LU(a).Determinant(), 1e-9);
+  a.SetCols(5);
+  a.SetRows(5);
+  ASSERT_DOUBLE_EQ(a.Determinant(), 0);
+  a.SetRows(4);
+  a.SetCols(4);
+  a.View(0, 0, 2, 2) *= 2;
+  ASSERT_NEAR(a.Determinant(), S21LU(a).Determinant(), 1e-9);
+  ASSERT_TRUE(a.InverseMatrix() * a == b.InverseMatrix() * b);
+  ASSERT_THROW(S21Matrix(3, 3).InverseMatrix(), std::invalid_argument);
+
+  // Four entries of two 4x4 matrices, evicted oldest first
+  S21ResultCache small(4 * 8 * 32);
+  S21Matrix::SetResultCache(&small);
+  for (int k = 0; k < 6; k++) {
+    b(3, 3) = k;
+    b.InverseMatrix();
+  }
+  ASSERT_EQ(small.GetUsed(), small.GetCapacity());
+  b(3, 3) = 5;
+  b.InverseMatrix();
+  b(3, 3) = 1;
+  b.InverseMatrix();
+  ASSERT_EQ(small.GetHits(), 1);
+  ASSERT_EQ(small.GetMisses(), 7);
+  S21Matrix big(12, 12);
+  big.Determinant();
+  ASSERT_EQ(small.GetUsed(), small.GetCapacity());
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&b, t] {
+      S21Matrix c = b;
+      c(0, 0) += t % 2;
+      for (int k = 0; k < 50; k++) {
+        c.Determinant();
+        c.InverseMatrix();
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(small.GetHits() + small.GetMisses(), 8 + 1 + 400);
+  small.Clear();
+  ASSERT_EQ(small.GetUsed(), 0u);
+  S21Matrix::SetResultCache(nullptr);
+}
+
+TEST(Test_63, Strassen) {
+  int crossover = s21::GetStrassenCrossover();
+  int threads = s21::GetNumThreads();
+  auto fill = [](S21Matrix* m, int seed) {
+    for (int i = 0; i < m->GetRows(); i++) {
+      for (int j = 0; j < m->GetCols(); j++) {
+        (*m)(i, j) = ((i * 7 + j * 13 + seed) % 17) / 8.0 - 1;
+      }
+    }
+  };
+  // Odd sizes at every level, rectangular shapes and transposed operands
+  const int shapes[][3] = {{64, 64, 64}, {67, 45, 81}, {33, 90, 47},
+                           {128, 20, 70}};
+  // One thread, the seven products in parallel, and threaded leaves
+  for (int parallel : {1, 4, 8}) {
+    s21::SetNumThreads(parallel);
+    for (const auto& shape : shapes) {
+      S21Matrix a(shape[0], shape[2]);
+      S21Matrix b(shape[2], shape[1]);
+      fill(&a, 1);
+      fill(&b, 5);
+      s21::SetStrassenCrossover(0);
+      S21Matrix expected = a * b;
+      S21Matrix expected_t = b.TransposedView() * a.TransposedView();
+      s21::SetStrassenCrossover(8);
+      ASSERT_TRUE((a * b).EqMatrix(expected, S21Tolerance::Absolute(1e-9)));
+      ASSERT_TRUE((b.TransposedView() * a.TransposedView())
+                      .EqMatrix(expected_t, S21Tolerance::Absolute(1e-9)));
+      S21Matrix c = a;
+      c.MulMatrix(b);
+      ASSERT_TRUE(c.EqMatrix(expected, S21Tolerance::Absolute(1e-9)));
+    }
+  }
+  s21::SetNumThreads(threads);
+  S21MatrixF f(40, 40);
+  for (int i = 0; i < 40; i++) {
+    for (int j = 0; j < 40; j++) {
+      f(i, j) = (i * j % 9) * 0.25f - 1;
+    }
+  }
+  s21::SetStrassenCrossover(0);
+  S21MatrixF expected_f = f * f;
+  s21::SetStrassenCrossover(4);
+  ASSERT_TRUE((f * f).EqMatrix(expected_f, S21Tolerance::Absolute(1e-4)));
+  s21::SetStrassenCrossover(crossover);
+}
+
+TEST(Test_64, AmortizedResize) {
+  // Appending 1000 rows one by one reallocates about log2(1000) times
+  S21Matrix a(1, 3);
+  a(0, 0) = 1;
+  long before = S21Matrix::GetAllocationCount();
+  for (int i = 1; i < 1000; i++) {
+    double row[] = {i + 1.0, -1.0 * i, 0.5 * i};
+    a.AppendRow(row);
+  }
+  ASSERT_LE(S21Matrix::GetAllocationCount() - before, 10);
+  ASSERT_EQ(a.GetRows(), 1000);
+  ASSERT_GE(a.GetRowCapacity(), 1000);
+  for (int i = 1; i < 1000; i++) {
+    ASSERT_EQ(a(i, 0), i + 1.0);
+    ASSERT_EQ(a(i, 1), -i);
+  }
+
+  // Shrinking and growing back within the capacity does not allocate and
+  // clears what comes back
+  before = S21Matrix::GetAllocationCount();
+  a.SetRows(10);
+  a.SetCols(2);
+  a.SetCols(a.GetColCapacity());
+  a.SetRows(500);
+  ASSERT_EQ(S21Matrix::GetAllocationCount(), before);
+  ASSERT_EQ(a(9, 0), 10);
+  ASSERT_EQ(a(9, 2), 0);
+  ASSERT_EQ(a(10, 0), 0);
+
+  // Column growth past the padding keeps the rows and leaves room
+  a.SetCols(a.GetColCapacity() + 1);
+  ASSERT_GE(a.GetColCapacity(), 2 * a.GetCols() - 2);
+  ASSERT_EQ(a(9, 0), 10);
+  ASSERT_EQ(a(9, a.GetCols() - 1), 0);
+
+  // A copy and a shrunk matrix hash and compare like a fresh one
+  S21Matrix b(2, 3);
+  b(0, 0) = 1;
+  b(0, 1) = 2;
+  b(1, 2) = 3;
+  a.SetRows(2);
+  a.SetCols(3);
+  a(0, 1) = 2;
+  a(1, 0) = 0;
+  a(1, 1) = 0;
+  a(1, 2) = 3;
+  ASSERT_TRUE(a == b);
+  ASSERT_EQ(a.Hash(), b.Hash());
+  S21Matrix copy = a;
+  ASSERT_EQ(copy.GetRowCapacity(), 2);
+  ASSERT_TRUE(copy == b);
+  a.ShrinkToFit();
+  ASSERT_EQ(a.GetRowCapacity(), 2);
+  ASSERT_EQ(a.GetColCapacity(), b.GetColCapacity());
+  ASSERT_TRUE(a == b);
+
+  // Rows from expressions and from the matrix itself
+  a.Reserve(8, 3);
+  ASSERT_EQ(a.GetRowCapacity(), 8);
+  a.AppendRow(b.View(0, 0, 1, 3) * 2.0);
+  a.AppendRow(a.View(2, 0, 1, 3) + b.View(1, 0, 1, 3));
+  ASSERT_EQ(a(3, 0), 2);
+  ASSERT_EQ(a(3, 2), 3);
+  a.ShrinkToFit();
+  a.AppendRow(a.View(3, 0, 1, 3));
+  a.ShrinkToFit();
+  a.AppendRow(&a(0, 0));
+  ASSERT_EQ(a.GetRows(), 6);
+  ASSERT_EQ(a(4, 2), 3);
+  ASSERT_EQ(a(5, 1), 2);
+  ASSERT_THROW(a.AppendRow(b), std::invalid_argument);
+  ASSERT_THROW(a.AppendRow(b.View(0, 0, 1, 2)), std::invalid_argument);
+
+  // Rows with the same layout as the matrix, appended at full capacity
+  S21Matrix c(1, 3);
+  c(0, 0) = 1;
+  c(0, 2) = 3;
+  c.AppendRow(c);
+  ASSERT_EQ(c.GetRowCapacity(), 2);
+  c.AppendRow(std::as_const(c).View(0, 0, 1, 3));
+  ASSERT_EQ(c.GetRows(), 3);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(c(i, 0), 1);
+    ASSERT_EQ(c(i, 1), 0);
+    ASSERT_EQ(c(i, 2), 3);
+  }
+}
+
+TEST(Test_65, RvalueOperands) {
+  S21Matrix a(4, 4);
+  S21Matrix b(4, 4);
+  S21Matrix c(4, 4);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      a(i, j) = i + 2 * j + (i == j ? 5 : 0);
+      b(i, j) = i - j;
+      c(i, j) = 1.5 * i * j;
+    }
+  }
+  const S21Matrix ca = a;
+  const S21Matrix cb = b;
+  S21Matrix ab = ca * cb;
+  S21Matrix abc = ab * c;
+
+  // Each chain allocates its result and nothing else
+  long before = S21Matrix::GetAllocationCount();
+  S21Matrix sum = (a + b) + c;
+  ASSERT_EQ(S21Matrix::GetAllocationCount() - before, 1);
+  before = S21Matrix::GetAllocationCount();
+  S21Matrix fused = a * b + c - b * 2.0;
+  ASSERT_EQ(S21Matrix::GetAllocationCount() - before, 1);
+  before = S21Matrix::GetAllocationCount();
+  S21Matrix chain = a * b * c;
+  S21Matrix left = c - a * b;
+  S21Matrix right = 2.0 * (a * b) + (c - b) * 0.5;
+  ASSERT_EQ(S21Matrix::GetAllocationCount() - before, 3);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      ASSERT_EQ(sum(i, j), a(i, j) + b(i, j) + c(i, j));
+      ASSERT_EQ(fused(i, j), ab(i, j) + c(i, j) - b(i, j) * 2);
+      ASSERT_EQ(left(i, j), c(i, j) - ab(i, j));
+      ASSERT_EQ(right(i, j), 2 * ab(i, j) + (c(i, j) - b(i, j)) * 0.5);
+    }
+  }
+  ASSERT_TRUE(chain.EqMatrix(abc, S21Tolerance::Bitwise()));
+
+  // Expiring square matrices are transposed and inverted in place
+  S21Matrix inverse = ca.InverseMatrix();
+  S21Matrix transpose = ca.Transpose();
+  before = S21Matrix::GetAllocationCount();
+  S21Matrix moved = S21Matrix(ca).InverseMatrix();
+  S21Matrix moved_t = S21Matrix(ca).Transpose();
+  ASSERT_EQ(S21Matrix::GetAllocationCount() - before, 2);
+  ASSERT_TRUE(moved.EqMatrix(inverse, S21Tolerance::Bitwise()));
+  ASSERT_TRUE(moved_t == transpose);
+
+  // An operand that overlaps the expiring one otherwise is still read
+  // before it is overwritten
+  S21Matrix expected = a.TransposedView() - a;
+  S21Matrix x = a;
+  S21Matrix overlap = x.TransposedView() - std::move(x);
+  ASSERT_TRUE(overlap.EqMatrix(expected, S21Tolerance::Bitwise()));
+
+  // Read-only operations work on const matrices
+  ASSERT_EQ(ca.GetRows(), 4);
+  ASSERT_EQ(ca(3, 1), a(3, 1));
+  ASSERT_THROW(ca(4, 0), std::out_of_range);
+  ASSERT_TRUE(ca == a && ca.EqMatrix(a) && ca.EqMatrix(a.View()));
+  ASSERT_NEAR(ca.Determinant(), S21LU(a).Determinant(), 1e-9);
+  ASSERT_TRUE(ca.CalcComplements() == a.CalcComplements());
+  ASSERT_TRUE(ca * b.View() == ab);
+  ASSERT_THROW(S21Matrix(2, 3) + S21Matrix(3, 2), std::invalid_argument);
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
 
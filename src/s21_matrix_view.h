@@ -0,0 +1,326 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_MATRIX_VIEW_H_
+#define S21_MATRIX_VIEW_H_
+
+#include <math.h>
+
+#include <stdexcept>
+#include <type_traits>
+
+#include "s21_lu.h"
+#include "s21_matrix_oop.h"
+#include "s21_thread_pool.h"
+
+// Non-owning window onto a matrix: a block, or every k-th row and column
+// of one. Element (row, col) is data[row * row_stride + col * col_stride]
+// of the parent buffer, so writes through a view land in the parent. A
+// view goes stale when its parent is resized, reassigned or destroyed.
+// S21BasicMatrixView<const T> is the read-only view of a const matrix.
+template <typename T>
+class S21BasicMatrixView : public S21MatrixExpr<S21BasicMatrixView<T>> {
+  template <typename U>
+  friend class S21BasicMatrix;
+  template <typename U>
+  friend class S21BasicMatrixView;
+  template <typename L, typename R, typename Op>
+  friend class S21MatrixBinaryExpr;
+  template <typename E>
+  friend class S21MatrixScaledExpr;
+
+ public:
+  using Scalar = std::remove_const_t<T>;
+
+  // Constructors
+  S21BasicMatrixView(T* data, int rows, int cols, int row_stride,
+                     int col_stride);
+  S21BasicMatrixView(const S21BasicMatrixView& other) = default;
+  template <typename U, typename = std::enable_if_t<
+                            std::is_same<const U, T>::value>>
+  S21BasicMatrixView(const S21BasicMatrixView<U>& other);
+
+  // Mutators
+  int GetRows() const { return rows_; }
+  int GetCols() const { return cols_; }
+  int GetRowStride() const { return row_stride_; }
+  int GetColStride() const { return col_stride_; }
+  T* Data() const { return data_; }
+  S21MatrixLayout<Scalar> Layout() const {
+    return {data_, rows_, cols_, row_stride_, col_stride_};
+  }
+  bool Aliases(const S21MatrixLayout<Scalar>& target) const {
+    return Layout().Conflicts(target);
+  }
+
+  // Views
+  S21BasicMatrixView View(int row, int col, int rows, int cols,
+                          int row_step = 1, int col_step = 1) const;
+
+  // Equals
+  template <typename E>
+  bool EqMatrix(const S21MatrixExpr<E>& other) const;
+  template <typename E>
+  bool EqMatrix(const S21MatrixExpr<E>& other,
+                const S21Tolerance& tolerance) const;
+
+  // Multiplication
+  void MulNumber(const Scalar num);
+
+  // Sum
+  template <typename E>
+  void SumMatrix(const S21MatrixExpr<E>& other);
+
+  // Sub
+  template <typename E>
+  void SubMatrix(const S21MatrixExpr<E>& other);
+
+  // Transpose
+  S21BasicMatrix<Scalar> Transpose() const;
+
+  // Algebra
+  Scalar Determinant() const;
+  S21BasicMatrix<Scalar> InverseMatrix() const;
+
+  // Overloaded
+  T& operator()(int row, int col) const;
+  // Assignment copies elements into the parent, it does not rebind
+  S21BasicMatrixView& operator=(const S21BasicMatrixView& other);
+  template <typename E>
+  S21BasicMatrixView& operator=(const S21MatrixExpr<E>& expr);
+  template <typename E>
+  S21BasicMatrixView& operator+=(const S21MatrixExpr<E>& expr);
+  template <typename E>
+  S21BasicMatrixView& operator-=(const S21MatrixExpr<E>& expr);
+  S21BasicMatrixView& operator*=(const Scalar num);
+  template <typename E>
+  bool operator==(const S21MatrixExpr<E>& other) const;
+
+ private:
+  T* data_;
+  int rows_;
+  int cols_;
+  int row_stride_;
+  int col_stride_;
+
+  // Extra functions
+  T& Element(long row, int col) const {
+    return data_[row * row_stride_ + static_cast<long>(col) * col_stride_];
+  }
+  Scalar At(long row, int col) const { return Element(row, col); }
+  template <typename E>
+  void Evaluate(const E& expr);
+  template <typename E>
+  void Store(const E& expr);
+};
+
+using S21MatrixView = S21BasicMatrixView<double>;
+using S21MatrixViewF = S21BasicMatrixView<float>;
+
+template <typename T>
+struct S21IsStridedExpr<S21BasicMatrixView<T>> : std::true_type {};
+
+// Constructors
+template <typename T>
+S21BasicMatrixView<T>::S21BasicMatrixView(T* data, int rows, int cols,
+                                          int row_stride, int col_stride)
+    : data_(data),
+      rows_(rows),
+      cols_(cols),
+      row_stride_(row_stride),
+      col_stride_(col_stride) {}
+
+template <typename T>
+template <typename U, typename>
+S21BasicMatrixView<T>::S21BasicMatrixView(const S21BasicMatrixView<U>& other)
+    : S21BasicMatrixView(other.data_, other.rows_, other.cols_,
+                         other.row_stride_, other.col_stride_) {}
+
+// Views
+template <typename T>
+S21BasicMatrixView<T> S21BasicMatrixView<T>::View(int row, int col, int rows,
+                                                  int cols, int row_step,
+                                                  int col_step) const {
+  if (rows <= 0 || cols <= 0) {
+    throw std::invalid_argument("Rows and cols must be greater than 0");
+  }
+  if (row_step <= 0 || col_step <= 0) {
+    throw std::invalid_argument("Steps must be greater than 0");
+  }
+  if (row < 0 || col < 0 ||
+      row + static_cast<long>(rows - 1) * row_step >= rows_ ||
+      col + static_cast<long>(cols - 1) * col_step >= cols_) {
+    throw std::out_of_range("Index is outside the matrix");
+  }
+  return S21BasicMatrixView(&Element(row, col), rows, cols,
+                            row_stride_ * row_step, col_stride_ * col_step);
+}
+
+// Equals
+template <typename T>
+template <typename E>
+bool S21BasicMatrixView<T>::EqMatrix(const S21MatrixExpr<E>& other) const {
+  return EqMatrix(
+      other, S21Tolerance::Absolute(S21ScalarTraits<Scalar>::kTolerance));
+}
+
+template <typename T>
+template <typename E>
+bool S21BasicMatrixView<T>::EqMatrix(const S21MatrixExpr<E>& other,
+                                     const S21Tolerance& tolerance) const {
+  const E& expr = other.Self();
+  if (cols_ != expr.GetCols() || rows_ != expr.GetRows()) return false;
+  if constexpr (S21IsStridedExpr<E>::value &&
+                std::is_same<typename E::Scalar, Scalar>::value) {
+    return s21::Close(Layout(), expr.Layout(), tolerance);
+  } else {
+    for (int i = 0; i < rows_; i++) {
+      for (int j = 0; j < cols_; j++) {
+        if (!s21::ElementClose<Scalar>(At(i, j), expr.At(i, j),
+                                       tolerance)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+}
+
+// Multiplication
+template <typename T>
+void S21BasicMatrixView<T>::MulNumber(const Scalar num) {
+  *this = *this * num;
+}
+
+// Sum
+template <typename T>
+template <typename E>
+void S21BasicMatrixView<T>::SumMatrix(const S21MatrixExpr<E>& other) {
+  *this = *this + other.Self();
+}
+
+// Sub
+template <typename T>
+template <typename E>
+void S21BasicMatrixView<T>::SubMatrix(const S21MatrixExpr<E>& other) {
+  *this = *this - other.Self();
+}
+
+// Transpose
+template <typename T>
+S21BasicMatrix<typename S21BasicMatrixView<T>::Scalar>
+S21BasicMatrixView<T>::Transpose() const {
+  return S21BasicMatrix<Scalar>(*this).Transpose();
+}
+
+// Algebra
+template <typename T>
+typename S21BasicMatrixView<T>::Scalar S21BasicMatrixView<T>::Determinant()
+    const {
+  if (rows_ != cols_) {
+    throw std::invalid_argument("The matrix is not square");
+  }
+  return S21BasicLU<Scalar>(*this).Determinant();
+}
+
+template <typename T>
+S21BasicMatrix<typename S21BasicMatrixView<T>::Scalar>
+S21BasicMatrixView<T>::InverseMatrix() const {
+  return S21BasicMatrix<Scalar>(*this).InverseMatrix();
+}
+
+// Overloaded
+template <typename T>
+T& S21BasicMatrixView<T>::operator()(int row, int col) const {
+  if (row >= rows_ || col >= cols_ || col < 0 || row < 0) {
+    throw std::out_of_range("Index is outside the matrix");
+  }
+  return Element(row, col);
+}
+
+template <typename T>
+S21BasicMatrixView<T>& S21BasicMatrixView<T>::operator=(
+    const S21BasicMatrixView& other) {
+  Evaluate(other);
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+S21BasicMatrixView<T>& S21BasicMatrixView<T>::operator=(
+    const S21MatrixExpr<E>& expr) {
+  Evaluate(expr.Self());
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+S21BasicMatrixView<T>& S21BasicMatrixView<T>::operator+=(
+    const S21MatrixExpr<E>& expr) {
+  Evaluate(*this + expr.Self());
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+S21BasicMatrixView<T>& S21BasicMatrixView<T>::operator-=(
+    const S21MatrixExpr<E>& expr) {
+  Evaluate(*this - expr.Self());
+  return *this;
+}
+
+template <typename T>
+S21BasicMatrixView<T>& S21BasicMatrixView<T>::operator*=(const Scalar num) {
+  MulNumber(num);
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+bool S21BasicMatrixView<T>::operator==(const S21MatrixExpr<E>& other) const {
+  return EqMatrix(other);
+}
+
+// Extra functions
+template <typename T>
+template <typename E>
+void S21BasicMatrixView<T>::Evaluate(const E& expr) {
+  static_assert(std::is_same<typename E::Scalar, Scalar>::value,
+                "Expression and view element types differ");
+  if (expr.GetRows() != rows_ || expr.GetCols() != cols_) {
+    throw std::invalid_argument("Different matrix dimensions");
+  }
+  if (expr.Aliases(Layout())) {
+    // The expression reads elements of the view before they are written
+    Store(S21BasicMatrix<Scalar>(expr));
+  } else {
+    Store(expr);
+  }
+}
+
+template <typename T>
+template <typename E>
+void S21BasicMatrixView<T>::Store(const E& expr) {
+  s21::ParallelFor(0, rows_, static_cast<long>(rows_) * cols_,
+                   [&](long lo, long hi) {
+                     for (long i = lo; i < hi; i++) {
+                       for (int j = 0; j < cols_; j++) {
+                         Element(i, j) = expr.At(i, j);
+                       }
+                     }
+                   });
+}
+
+#endif  // S21_MATRIX_VIEW_H_
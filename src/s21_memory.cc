@@ -0,0 +1,193 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_memory.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <new>
+
+namespace s21 {
+
+namespace {
+
+// Classes are powers of two from 64 bytes to 1 MiB; every block is
+// aligned to a cache line, which covers what S21Matrix asks for.
+constexpr size_t kMinBlock = 64;
+constexpr int kClasses = 15;
+constexpr size_t kBlockAlignment = 64;
+// Free blocks kept per class and thread before they go back to the system
+constexpr size_t kMaxCached = 256;
+// Bytes of free blocks kept per thread, over all classes
+constexpr size_t kMaxCachedBytes = 4 << 20;
+
+int SizeClass(size_t bytes) {
+  int index = 0;
+  while ((kMinBlock << index) < bytes) {
+    index++;
+  }
+  return index;
+}
+
+void* AllocateBlock(size_t bytes, size_t alignment) {
+  return operator new(bytes, std::align_val_t(alignment));
+}
+
+void FreeBlock(void* pointer, size_t alignment) {
+  operator delete(pointer, std::align_val_t(alignment));
+}
+
+// Set once the cache of this thread is destroyed, so late frees (from
+// objects with static storage duration) bypass it
+thread_local bool cache_destroyed = false;
+
+struct ThreadCache {
+  std::vector<void*> free[kClasses];
+  size_t bytes = 0;
+
+  ~ThreadCache() {
+    cache_destroyed = true;
+    for (auto& list : free) {
+      for (void* block : list) {
+        FreeBlock(block, kBlockAlignment);
+      }
+    }
+  }
+};
+
+ThreadCache& LocalCache() {
+  thread_local ThreadCache cache;
+  return cache;
+}
+
+}  // namespace
+
+PoolResource* PoolResource::Instance() {
+  static PoolResource resource;
+  return &resource;
+}
+
+size_t PoolResource::GetCachedBytes() {
+  return cache_destroyed ? 0 : LocalCache().bytes;
+}
+
+void* PoolResource::do_allocate(size_t bytes, size_t alignment) {
+  int index = SizeClass(bytes);
+  if (index >= kClasses || alignment > kBlockAlignment) {
+    return AllocateBlock(bytes, std::max(alignment, kBlockAlignment));
+  }
+  if (cache_destroyed) {
+    return AllocateBlock(kMinBlock << index, kBlockAlignment);
+  }
+  ThreadCache& cache = LocalCache();
+  std::vector<void*>& list = cache.free[index];
+  if (list.empty()) {
+    return AllocateBlock(kMinBlock << index, kBlockAlignment);
+  }
+  void* block = list.back();
+  list.pop_back();
+  cache.bytes -= kMinBlock << index;
+  return block;
+}
+
+void PoolResource::do_deallocate(void* pointer, size_t bytes,
+                                 size_t alignment) {
+  int index = SizeClass(bytes);
+  if (index >= kClasses || alignment > kBlockAlignment) {
+    FreeBlock(pointer, std::max(alignment, kBlockAlignment));
+    return;
+  }
+  if (cache_destroyed) {
+    FreeBlock(pointer, kBlockAlignment);
+    return;
+  }
+  ThreadCache& cache = LocalCache();
+  std::vector<void*>& list = cache.free[index];
+  size_t size = kMinBlock << index;
+  if (list.size() < kMaxCached && cache.bytes + size <= kMaxCachedBytes) {
+    list.push_back(pointer);
+    cache.bytes += size;
+  } else {
+    FreeBlock(pointer, kBlockAlignment);
+  }
+}
+
+bool PoolResource::do_is_equal(const std::pmr::memory_resource& other) const
+    noexcept {
+  return dynamic_cast<const PoolResource*>(&other) != nullptr;
+}
+
+// Constructors
+ArenaResource::ArenaResource(size_t chunk_size)
+    : chunk_size_(std::max<size_t>(chunk_size, kMinBlock)),
+      offset_(0),
+      used_(0) {}
+
+// Destructors
+ArenaResource::~ArenaResource() {
+  for (Chunk& chunk : chunks_) {
+    FreeBlock(chunk.data, kBlockAlignment);
+  }
+}
+
+void ArenaResource::Reset() {
+  if (chunks_.size() > 1) {
+    // Replace the chunk list with one chunk big enough for the whole
+    // last round, so a steady workload stops allocating after warm-up
+    size_t total = 0;
+    for (Chunk& chunk : chunks_) {
+      total += chunk.size;
+      FreeBlock(chunk.data, kBlockAlignment);
+    }
+    chunks_.clear();
+    AddChunk(total);
+  }
+  offset_ = 0;
+  used_ = 0;
+}
+
+size_t ArenaResource::GetUsed() const { return used_; }
+
+void* ArenaResource::do_allocate(size_t bytes, size_t alignment) {
+  size_t start = 0;
+  if (!chunks_.empty()) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(chunks_.back().data);
+    start = ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+  }
+  if (chunks_.empty() || start + bytes > chunks_.back().size) {
+    AddChunk(std::max(chunk_size_, bytes + alignment));
+    uintptr_t base = reinterpret_cast<uintptr_t>(chunks_.back().data);
+    start = ((base + alignment - 1) & ~(alignment - 1)) - base;
+  }
+  offset_ = start + bytes;
+  used_ += bytes;
+  return chunks_.back().data + start;
+}
+
+void ArenaResource::do_deallocate(void*, size_t, size_t) {}
+
+bool ArenaResource::do_is_equal(const std::pmr::memory_resource& other) const
+    noexcept {
+  return this == &other;
+}
+
+void ArenaResource::AddChunk(size_t size) {
+  chunks_.push_back({static_cast<char*>(AllocateBlock(size, kBlockAlignment)),
+                     size});
+  offset_ = 0;
+}
+
+}  // namespace s21
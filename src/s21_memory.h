@@ -0,0 +1,80 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_MEMORY_H_
+#define S21_MEMORY_H_
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace s21 {
+
+// Size-class pool with per-thread free lists. Freed blocks are kept for
+// reuse by the thread that frees them, up to a few MiB per thread, and
+// returned to the system when that thread exits. All instances share the
+// same caches and compare equal.
+class PoolResource : public std::pmr::memory_resource {
+ public:
+  // Process-wide instance
+  static PoolResource* Instance();
+  // Bytes of free blocks cached by the calling thread
+  static size_t GetCachedBytes();
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+      noexcept override;
+};
+
+// Bump-pointer arena: allocation is a pointer increment, deallocation is a
+// no-op and Reset() releases everything at once, e.g. after each request.
+// Not thread-safe; use one arena per thread or per request.
+class ArenaResource : public std::pmr::memory_resource {
+ public:
+  explicit ArenaResource(size_t chunk_size = 1 << 20);
+  ArenaResource(const ArenaResource&) = delete;
+  ArenaResource& operator=(const ArenaResource&) = delete;
+  ~ArenaResource() override;
+
+  // Makes all memory handed out so far reusable. Matrices allocated from
+  // the arena must be destroyed before the call.
+  void Reset();
+
+  // Bytes handed out since the last Reset()
+  size_t GetUsed() const;
+
+ private:
+  struct Chunk {
+    char* data;
+    size_t size;
+  };
+
+  std::vector<Chunk> chunks_;
+  size_t chunk_size_;
+  size_t offset_;
+  size_t used_;
+
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+      noexcept override;
+  void AddChunk(size_t size);
+};
+
+}  // namespace s21
+
+#endif  // S21_MEMORY_H_
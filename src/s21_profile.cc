@@ -0,0 +1,272 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_profile.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace s21 {
+
+thread_local ProfileFastPath profile_fast_path;
+
+namespace {
+
+// Per-thread counters, registered for snapshots while the thread lives
+struct ThreadProfile {
+  ProfileCounters operations[kOperationCount];
+  std::atomic<uint64_t> allocations;
+  std::atomic<uint64_t> allocated_bytes;
+
+  ThreadProfile();
+  ~ThreadProfile();
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<ThreadProfile*> threads;
+  // Counts of threads that have exited
+  ProfileSnapshot retired;
+  // Totals at the last ResetProfile()
+  ProfileSnapshot baseline;
+};
+
+Registry& GetRegistry() {
+  // Never destroyed: threads may exit after static destruction begins
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+uint64_t Load(const std::atomic<uint64_t>& counter) {
+  return counter.load(std::memory_order_relaxed);
+}
+
+void Accumulate(const ThreadProfile& thread, ProfileSnapshot* total) {
+  for (int op = 0; op < kOperationCount; op++) {
+    const ProfileCounters& from = thread.operations[op];
+    OperationStats& to = total->operations[op];
+    to.calls += Load(from.calls);
+    to.nanoseconds += Load(from.nanoseconds);
+    to.flops += Load(from.flops);
+    to.bytes += Load(from.bytes);
+    for (int r = 0; r < kShapeBuckets; r++) {
+      for (int c = 0; c < kShapeBuckets; c++) {
+        to.shapes[r][c] += Load(from.shapes[r][c]);
+      }
+    }
+  }
+  total->allocations += Load(thread.allocations);
+  total->allocated_bytes += Load(thread.allocated_bytes);
+}
+
+ThreadProfile::ThreadProfile() : operations(), allocations(0),
+                                 allocated_bytes(0) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.threads.push_back(this);
+}
+
+ThreadProfile::~ThreadProfile() {
+  profile_fast_path.counters = nullptr;
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  Accumulate(*this, &registry.retired);
+  for (size_t i = 0; i < registry.threads.size(); i++) {
+    if (registry.threads[i] == this) {
+      registry.threads[i] = registry.threads.back();
+      registry.threads.pop_back();
+      break;
+    }
+  }
+}
+
+ThreadProfile& LocalProfile() {
+  thread_local ThreadProfile profile;
+  return profile;
+}
+
+ProfileSnapshot Totals(Registry& registry) {
+  ProfileSnapshot total = registry.retired;
+  for (const ThreadProfile* thread : registry.threads) {
+    Accumulate(*thread, &total);
+  }
+  return total;
+}
+
+void AppendLine(std::string* out, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+void AppendLine(std::string* out, const char* format, ...) {
+  char line[256];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  *out += line;
+}
+
+}  // namespace
+
+const char* OperationName(Operation operation) {
+  // Same order as Operation
+  static const char* const kNames[kOperationCount] = {
+      "copy", "resize", "eq_matrix", "hash", "sum_matrix", "sub_matrix",
+      "mul_number", "mul_matrix", "evaluate", "transpose", "transpose_in_place",
+      "determinant", "inverse_matrix", "calc_complements", "solve", "lu",
+      "cholesky", "qr", "save", "load", "map_file", "mul_files"};
+  return kNames[static_cast<int>(operation)];
+}
+
+ProfileSnapshot GetProfile() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  ProfileSnapshot result = Totals(registry);
+  const ProfileSnapshot& base = registry.baseline;
+  for (int op = 0; op < kOperationCount; op++) {
+    OperationStats& to = result.operations[op];
+    const OperationStats& from = base.operations[op];
+    to.calls -= from.calls;
+    to.nanoseconds -= from.nanoseconds;
+    to.flops -= from.flops;
+    to.bytes -= from.bytes;
+    for (int r = 0; r < kShapeBuckets; r++) {
+      for (int c = 0; c < kShapeBuckets; c++) {
+        to.shapes[r][c] -= from.shapes[r][c];
+      }
+    }
+  }
+  result.allocations -= base.allocations;
+  result.allocated_bytes -= base.allocated_bytes;
+  return result;
+}
+
+// Counters are never cleared, since other threads own them; the current
+// totals become the zero point instead
+void ResetProfile() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.baseline = Totals(registry);
+}
+
+std::string ToPrometheus(const ProfileSnapshot& snapshot) {
+  struct Metric {
+    const char* name;
+    const char* help;
+    uint64_t OperationStats::*field;
+  };
+  const Metric kMetrics[] = {
+      {"s21_matrix_calls_total", "Calls of each matrix operation.",
+       &OperationStats::calls},
+      {"s21_matrix_flops_total", "Floating point operations performed.",
+       &OperationStats::flops},
+      {"s21_matrix_bytes_total", "Bytes of matrix elements read and written.",
+       &OperationStats::bytes}};
+  std::string out;
+  for (const Metric& metric : kMetrics) {
+    AppendLine(&out, "# HELP %s %s\n# TYPE %s counter\n", metric.name,
+               metric.help, metric.name);
+    for (int op = 0; op < kOperationCount; op++) {
+      AppendLine(&out, "%s{op=\"%s\"} %llu\n", metric.name,
+                 OperationName(static_cast<Operation>(op)),
+                 static_cast<unsigned long long>(
+                     snapshot.operations[op].*metric.field));
+    }
+  }
+  AppendLine(&out,
+             "# HELP s21_matrix_seconds_total Time spent in each matrix "
+             "operation.\n# TYPE s21_matrix_seconds_total counter\n");
+  for (int op = 0; op < kOperationCount; op++) {
+    AppendLine(&out, "s21_matrix_seconds_total{op=\"%s\"} %.9f\n",
+               OperationName(static_cast<Operation>(op)),
+               snapshot.operations[op].nanoseconds * 1e-9);
+  }
+  AppendLine(&out,
+             "# HELP s21_matrix_shape_calls_total Calls by operand rows and "
+             "cols, rounded up to a power of two.\n"
+             "# TYPE s21_matrix_shape_calls_total counter\n");
+  for (int op = 0; op < kOperationCount; op++) {
+    for (int r = 0; r < kShapeBuckets; r++) {
+      for (int c = 0; c < kShapeBuckets; c++) {
+        uint64_t calls = snapshot.operations[op].shapes[r][c];
+        if (calls == 0) continue;
+        std::string rows = r == kShapeBuckets - 1
+                               ? "+Inf"
+                               : std::to_string(1L << r);
+        std::string cols = c == kShapeBuckets - 1
+                               ? "+Inf"
+                               : std::to_string(1L << c);
+        AppendLine(&out,
+                   "s21_matrix_shape_calls_total{op=\"%s\",rows=\"%s\","
+                   "cols=\"%s\"} %llu\n",
+                   OperationName(static_cast<Operation>(op)), rows.c_str(),
+                   cols.c_str(), static_cast<unsigned long long>(calls));
+      }
+    }
+  }
+  AppendLine(&out,
+             "# HELP s21_matrix_allocations_total Matrix buffers allocated."
+             "\n# TYPE s21_matrix_allocations_total counter\n"
+             "s21_matrix_allocations_total %llu\n"
+             "# HELP s21_matrix_allocated_bytes_total Bytes of matrix "
+             "buffers allocated.\n"
+             "# TYPE s21_matrix_allocated_bytes_total counter\n"
+             "s21_matrix_allocated_bytes_total %llu\n",
+             static_cast<unsigned long long>(snapshot.allocations),
+             static_cast<unsigned long long>(snapshot.allocated_bytes));
+  return out;
+}
+
+void RecordAllocation(size_t bytes) {
+  ThreadProfile& profile = LocalProfile();
+  AddRelaxed(profile.allocations, 1);
+  AddRelaxed(profile.allocated_bytes, bytes);
+}
+
+void ProfileScope::Start(Operation operation, long rows, long cols,
+                         double flops, double bytes, unsigned weight) {
+  ProfileFastPath& fast = profile_fast_path;
+  if (fast.counters == nullptr) {
+    fast.counters = LocalProfile().operations;
+  }
+  fast.untimed[static_cast<int>(operation)] = 0;
+  operation_ = operation;
+  rows_ = rows;
+  cols_ = cols;
+  flops_ = flops;
+  bytes_ = bytes;
+  weight_ = weight;
+  start_ = std::chrono::steady_clock::now();
+}
+
+void ProfileScope::Finish() {
+  int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start_)
+                        .count();
+  int op = static_cast<int>(operation_);
+  ProfileFastPath& fast = profile_fast_path;
+  ProfileCounters& counters = fast.counters[op];
+  AddRelaxed(counters.nanoseconds, weight_ * elapsed);
+  fast.cheap[op] = elapsed < kCheapNanoseconds;
+  AddRelaxed(counters.calls, 1);
+  AddRelaxed(counters.flops, static_cast<uint64_t>(flops_));
+  AddRelaxed(counters.bytes, static_cast<uint64_t>(bytes_));
+  AddRelaxed(counters.shapes[ShapeBucket(rows_)][ShapeBucket(cols_)], 1);
+}
+
+}  // namespace s21
@@ -0,0 +1,196 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_PROFILE_H_
+#define S21_PROFILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// Operation counters, compiled in with -DS21_MATRIX_PROFILE. Without the
+// flag S21_PROFILE(...) expands to nothing and the snapshot stays zero.
+#ifdef S21_MATRIX_PROFILE
+#define S21_PROFILE(...) ::s21::ProfileScope s21_profile_scope(__VA_ARGS__)
+#define S21_PROFILE_ALLOCATION(bytes) ::s21::RecordAllocation(bytes)
+#else
+#define S21_PROFILE(...) static_cast<void>(0)
+#define S21_PROFILE_ALLOCATION(bytes) static_cast<void>(0)
+#endif
+
+namespace s21 {
+
+enum class Operation {
+  kCopy,
+  kResize,
+  kEqMatrix,
+  kHash,
+  kSumMatrix,
+  kSubMatrix,
+  kMulNumber,
+  kMulMatrix,
+  kEvaluate,
+  kTranspose,
+  kTransposeInPlace,
+  kDeterminant,
+  kInverseMatrix,
+  kCalcComplements,
+  kSolve,
+  kLU,
+  kCholesky,
+  kQR,
+  kSave,
+  kLoad,
+  kMapFile,
+  kMulFiles,
+  kCount
+};
+
+constexpr int kOperationCount = static_cast<int>(Operation::kCount);
+// Bucket b counts dimensions up to 2^b; the last one everything larger
+constexpr int kShapeBuckets = 14;
+// A clock read costs tens of nanoseconds, as much as a whole 4x4 sum.
+// Once a timed call of an operation took less than kCheapNanoseconds,
+// its calls on that thread are timed one in kTimeSampling, until a timed
+// one is slower. Calls on kTimedElements elements or moving kTimedBytes
+// are always timed, whatever the operation cost before.
+constexpr double kTimedBytes = 64 * 1024;
+constexpr double kTimedElements = 4096;
+constexpr int64_t kCheapNanoseconds = 2000;
+constexpr unsigned kTimeSampling = 256;
+
+// Snake case name used as the Prometheus label, e.g. "mul_matrix"
+const char* OperationName(Operation operation);
+
+struct OperationStats {
+  uint64_t calls;
+  // Wall time, including the operations it calls itself. Cheap calls
+  // are timed one in kTimeSampling and weighted accordingly, so for them
+  // this is an estimate.
+  uint64_t nanoseconds;
+  uint64_t flops;
+  // Matrix elements read and written, in bytes
+  uint64_t bytes;
+  // Calls by the row and the column bucket of the first operand
+  uint64_t shapes[kShapeBuckets][kShapeBuckets];
+};
+
+struct ProfileSnapshot {
+  OperationStats operations[kOperationCount];
+  // Matrix buffers, counted where they are allocated
+  uint64_t allocations;
+  uint64_t allocated_bytes;
+};
+
+// Totals of all threads since the last ResetProfile()
+ProfileSnapshot GetProfile();
+void ResetProfile();
+// Prometheus text exposition format
+std::string ToPrometheus(const ProfileSnapshot& snapshot);
+
+void RecordAllocation(size_t bytes);
+
+// Counters of one operation in one thread. Only the owning thread stores
+// to them; snapshots load them from other threads, hence relaxed atomics.
+struct ProfileCounters {
+  std::atomic<uint64_t> calls;
+  std::atomic<uint64_t> nanoseconds;
+  std::atomic<uint64_t> flops;
+  std::atomic<uint64_t> bytes;
+  std::atomic<uint64_t> shapes[kShapeBuckets][kShapeBuckets];
+};
+
+// What the inline part of ProfileScope reads. It has no constructor, so
+// the thread-local instance is zero-initialized and reached without an
+// initialization check.
+struct ProfileFastPath {
+  // Counters of this thread, null until its first timed call
+  ProfileCounters* counters;
+  // Whether the last timed call of the operation was cheap, and the
+  // cheap calls seen since then
+  bool cheap[kOperationCount];
+  unsigned untimed[kOperationCount];
+};
+
+extern thread_local ProfileFastPath profile_fast_path;
+
+inline void AddRelaxed(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+}
+
+// Smallest b with size <= 2^b, at most kShapeBuckets - 1
+inline int ShapeBucket(long size) {
+  if (size <= 1) return 0;
+  int bucket = 64 - __builtin_clzll(static_cast<uint64_t>(size - 1));
+  return bucket < kShapeBuckets - 1 ? bucket : kShapeBuckets - 1;
+}
+
+// Counts one call of an operation on a rows x cols operand and times it
+// until the end of the scope. Counters live in the calling thread and
+// only it writes them, so recording takes no lock and no atomic
+// read-modify-write. A call that is not timed is counted inline, with
+// one thread-local access and no clock read.
+class ProfileScope {
+ public:
+  __attribute__((always_inline)) ProfileScope(Operation operation, long rows,
+                                              long cols, double flops,
+                                              double bytes)
+      : weight_(0) {
+    ProfileFastPath& fast = profile_fast_path;
+    int op = static_cast<int>(operation);
+    bool sampled = fast.cheap[op] && bytes < kTimedBytes &&
+                   static_cast<double>(rows) * cols < kTimedElements;
+    if (sampled && ++fast.untimed[op] < kTimeSampling &&
+        fast.counters != nullptr) {
+      ProfileCounters& counters = fast.counters[op];
+      AddRelaxed(counters.calls, 1);
+      AddRelaxed(counters.flops, static_cast<uint64_t>(flops));
+      AddRelaxed(counters.bytes, static_cast<uint64_t>(bytes));
+      AddRelaxed(counters.shapes[ShapeBucket(rows)][ShapeBucket(cols)], 1);
+    } else {
+      Start(operation, rows, cols, flops, bytes,
+            sampled ? kTimeSampling : 1);
+    }
+  }
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+  ~ProfileScope() {
+    if (weight_ != 0) Finish();
+  }
+
+ private:
+  // Calls the time of this one stands for, 0 when it is not timed
+  unsigned weight_;
+  // Set only for a timed call
+  Operation operation_;
+  long rows_;
+  long cols_;
+  double flops_;
+  double bytes_;
+  std::chrono::steady_clock::time_point start_;
+
+  // weight is kTimeSampling for the sampled call of a cheap operation
+  void Start(Operation operation, long rows, long cols, double flops,
+             double bytes, unsigned weight);
+  void Finish();
+};
+
+}  // namespace s21
+
+#endif  // S21_PROFILE_H_
@@ -0,0 +1,161 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_qr.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "s21_thread_pool.h"
+
+// Constructors
+template <typename T>
+S21BasicQR<T>::S21BasicQR(S21BasicMatrix<T> A)
+    : qr_(std::move(A)), tau_(qr_.cols_), rank_deficient_(false) {
+  if (qr_.rows_ < qr_.cols_) {
+    throw std::invalid_argument("The matrix has fewer rows than cols");
+  }
+  S21_PROFILE(s21::Operation::kQR, qr_.rows_, qr_.cols_,
+              2.0 * qr_.Size() * qr_.cols_ -
+                  2.0 / 3 * qr_.cols_ * qr_.cols_ * qr_.cols_,
+              2.0 * sizeof(T) * qr_.Size());
+  Factorize();
+}
+
+// Accessors
+template <typename T>
+int S21BasicQR<T>::GetRows() const { return qr_.rows_; }
+
+template <typename T>
+int S21BasicQR<T>::GetCols() const { return qr_.cols_; }
+
+template <typename T>
+const S21BasicMatrix<T>& S21BasicQR<T>::GetFactors() const { return qr_; }
+
+// Algebra
+template <typename T>
+bool S21BasicQR<T>::IsRankDeficient() const { return rank_deficient_; }
+
+template <typename T>
+S21BasicMatrix<T> S21BasicQR<T>::Solve(const S21BasicMatrix<T>& b) const {
+  if (b.rows_ != qr_.rows_) {
+    throw std::invalid_argument("Different matrix dimensions");
+  }
+  if (rank_deficient_) {
+    throw std::invalid_argument("The matrix is rank deficient");
+  }
+  S21_PROFILE(s21::Operation::kSolve, b.rows_, b.cols_,
+              4.0 * qr_.Size() * b.cols_,
+              sizeof(T) * (qr_.Size() + 2.0 * b.Size()));
+  int n = qr_.cols_;
+  S21BasicMatrix<T> c = b;
+  S21BasicMatrix<T> result(n, b.cols_);
+  long work = static_cast<long>(qr_.rows_) * n * b.cols_;
+  s21::ParallelFor(0, b.cols_, work, [&](long lo, long hi) {
+    for (int k = 0; k < n; k++) {
+      Reflect(k, &c, lo, hi);
+    }
+    // R * X = (Q^T * B)[0:n] by back substitution
+    for (int i = n - 1; i >= 0; i--) {
+      T* row_i = result.Row(i);
+      std::copy(c.Row(i) + lo, c.Row(i) + hi, row_i + lo);
+      const T* r_i = qr_.Row(i);
+      for (int k = i + 1; k < n; k++) {
+        const T* row_k = result.Row(k);
+        for (long j = lo; j < hi; j++) {
+          row_i[j] -= r_i[k] * row_k[j];
+        }
+      }
+      for (long j = lo; j < hi; j++) {
+        row_i[j] /= r_i[i];
+      }
+    }
+  });
+  return result;
+}
+
+// Extra functions
+template <typename T>
+void S21BasicQR<T>::Factorize() {
+  int m = qr_.rows_;
+  int n = qr_.cols_;
+  T max_abs = 0;
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < n; j++) {
+      max_abs = fmax(max_abs, fabs(qr_.Row(i)[j]));
+    }
+  }
+  // Diagonal entries of R below this are rounding noise of a rank
+  // deficient input, as for the pivots of S21LU
+  T tolerance = m * S21ScalarTraits<T>::kEpsilon * max_abs;
+  for (int k = 0; k < n; k++) {
+    T norm = 0;
+    for (int i = k; i < m; i++) {
+      norm += qr_.Row(i)[k] * qr_.Row(i)[k];
+    }
+    norm = std::sqrt(norm);
+    T head = qr_.Row(k)[k];
+    // The sign opposite to the head avoids cancellation in head - beta
+    T beta = head >= 0 ? -norm : norm;
+    if (norm <= tolerance) {
+      rank_deficient_ = true;
+      tau_[k] = 0;
+      continue;
+    }
+    tau_[k] = (beta - head) / beta;
+    T scale = 1 / (head - beta);
+    for (int i = k + 1; i < m; i++) {
+      qr_.Row(i)[k] *= scale;
+    }
+    qr_.Row(k)[k] = beta;
+    long work = static_cast<long>(m - k) * (n - k);
+    s21::ParallelFor(k + 1, n, work, [&](long lo, long hi) {
+      Reflect(k, &qr_, lo, hi);
+    });
+  }
+}
+
+// The reflector is I - tau * v * v^T: w = tau * v^T * B is accumulated
+// row by row, then B -= v * w, so all access to B is along its rows
+template <typename T>
+void S21BasicQR<T>::Reflect(int k, S21BasicMatrix<T>* b, long lo,
+                            long hi) const {
+  if (tau_[k] == 0) return;
+  int m = qr_.rows_;
+  T* row_k = b->Row(k);
+  std::vector<T> w(row_k + lo, row_k + hi);
+  for (int i = k + 1; i < m; i++) {
+    T v = qr_.Row(i)[k];
+    const T* row_i = b->Row(i);
+    for (long j = lo; j < hi; j++) {
+      w[j - lo] += v * row_i[j];
+    }
+  }
+  for (long j = lo; j < hi; j++) {
+    w[j - lo] *= tau_[k];
+    row_k[j] -= w[j - lo];
+  }
+  for (int i = k + 1; i < m; i++) {
+    T v = qr_.Row(i)[k];
+    T* row_i = b->Row(i);
+    for (long j = lo; j < hi; j++) {
+      row_i[j] -= v * w[j - lo];
+    }
+  }
+}
+
+template class S21BasicQR<float>;
+template class S21BasicQR<double>;
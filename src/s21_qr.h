@@ -0,0 +1,60 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_QR_H_
+#define S21_QR_H_
+
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+// Householder QR factorization of an m x n matrix with m >= n: A = Q * R.
+// R is stored on and above the diagonal; below it, column k holds the
+// Householder vector of reflector k, whose leading 1 is not stored.
+template <typename T>
+class S21BasicQR {
+ public:
+  // Constructors
+  explicit S21BasicQR(S21BasicMatrix<T> A);
+
+  // Accessors
+  int GetRows() const;
+  int GetCols() const;
+  const S21BasicMatrix<T>& GetFactors() const;
+
+  // Algebra
+  bool IsRankDeficient() const;
+  // Least-squares X minimizing |A * X - B| column by column; the exact
+  // solution when A is square. Q^T * B is formed by the reflectors, Q
+  // itself is never built.
+  S21BasicMatrix<T> Solve(const S21BasicMatrix<T>& b) const;
+
+ private:
+  S21BasicMatrix<T> qr_;
+  std::vector<T> tau_;
+  bool rank_deficient_;
+
+  // Extra functions
+  void Factorize();
+  // Applies reflector k to columns [lo, hi) of B
+  void Reflect(int k, S21BasicMatrix<T>* b, long lo, long hi) const;
+};
+
+using S21QR = S21BasicQR<double>;
+using S21QRF = S21BasicQR<float>;
+
+extern template class S21BasicQR<float>;
+extern template class S21BasicQR<double>;
+#endif  // S21_QR_H_
@@ -0,0 +1,128 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_result_cache.h"
+
+#include <utility>
+
+// Constructors
+template <typename T>
+S21BasicResultCache<T>::S21BasicResultCache(size_t capacity)
+    : capacity_(capacity), used_(0), hits_(0), misses_(0) {}
+
+// Accessors
+template <typename T>
+size_t S21BasicResultCache<T>::GetCapacity() const {
+  return capacity_;
+}
+
+template <typename T>
+size_t S21BasicResultCache<T>::GetUsed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return used_;
+}
+
+template <typename T>
+long S21BasicResultCache<T>::GetHits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+template <typename T>
+long S21BasicResultCache<T>::GetMisses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+// Mutators
+template <typename T>
+void S21BasicResultCache<T>::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  used_ = 0;
+}
+
+// Hashing and the bitwise check run outside the lock; the hash itself is
+// memoized by the matrix until it is modified
+template <typename T>
+std::shared_ptr<const S21BasicMatrix<T>> S21BasicResultCache<T>::Find(
+    s21::Operation operation, const S21BasicMatrix<T>& matrix) {
+  Key key = MakeKey(operation, matrix);
+  std::shared_ptr<const S21BasicMatrix<T>> operand;
+  std::shared_ptr<const S21BasicMatrix<T>> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(key);
+    if (found == index_.end()) {
+      misses_++;
+      return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, found->second);
+    operand = found->second->operand;
+    result = found->second->result;
+  }
+  bool same = matrix.EqMatrix(*operand, S21Tolerance::Bitwise());
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!same) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  return result;
+}
+
+template <typename T>
+void S21BasicResultCache<T>::Insert(s21::Operation operation,
+                                    const S21BasicMatrix<T>& matrix,
+                                    const S21BasicMatrix<T>& result) {
+  size_t bytes = sizeof(T) * (static_cast<size_t>(matrix.GetRows()) *
+                                  matrix.GetCols() +
+                              static_cast<size_t>(result.GetRows()) *
+                                  result.GetCols());
+  if (bytes > capacity_) return;
+  Key key = MakeKey(operation, matrix);
+  Entry entry{key, std::make_shared<const S21BasicMatrix<T>>(matrix),
+              std::make_shared<const S21BasicMatrix<T>>(result), bytes};
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    // Another thread stored it first, or a hash collision: keep the newest
+    Erase(found->second);
+  }
+  while (used_ + bytes > capacity_) {
+    Erase(std::prev(entries_.end()));
+  }
+  entries_.push_front(std::move(entry));
+  index_.emplace(key, entries_.begin());
+  used_ += bytes;
+}
+
+// Extra functions
+template <typename T>
+typename S21BasicResultCache<T>::Key S21BasicResultCache<T>::MakeKey(
+    s21::Operation operation, const S21BasicMatrix<T>& matrix) {
+  return {operation, matrix.GetRows(), matrix.GetCols(), matrix.Hash()};
+}
+
+template <typename T>
+void S21BasicResultCache<T>::Erase(typename List::iterator entry) {
+  used_ -= entry->bytes;
+  index_.erase(entry->key);
+  entries_.erase(entry);
+}
+
+template class S21BasicResultCache<float>;
+template class S21BasicResultCache<double>;
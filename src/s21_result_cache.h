@@ -0,0 +1,113 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_RESULT_CACHE_H_
+#define S21_RESULT_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "s21_matrix_oop.h"
+
+// Bounded LRU cache of Determinant(), InverseMatrix() and CalcComplements()
+// results, keyed by the operation, the shape and the content hash of the
+// operand. Matrices look it up once S21BasicMatrix<T>::SetResultCache()
+// installs it.
+//
+// A hit is confirmed by comparing the operand with a stored copy bit for
+// bit, so a hash collision costs a recomputation, never a wrong result.
+// Every method is thread-safe. Results are computed outside the lock, so
+// two threads missing on the same key both compute it.
+template <typename T>
+class S21BasicResultCache {
+ public:
+  // Constructors
+  // capacity bounds the bytes of the stored operands and results
+  explicit S21BasicResultCache(size_t capacity);
+  S21BasicResultCache(const S21BasicResultCache&) = delete;
+  S21BasicResultCache& operator=(const S21BasicResultCache&) = delete;
+
+  // Accessors
+  size_t GetCapacity() const;
+  size_t GetUsed() const;
+  long GetHits() const;
+  long GetMisses() const;
+
+  // Mutators
+  void Clear();
+
+  // Result of operation on matrix, or nullptr when it is not cached
+  std::shared_ptr<const S21BasicMatrix<T>> Find(
+      s21::Operation operation, const S21BasicMatrix<T>& matrix);
+  // Stores a result, evicting the least recently used ones to make room.
+  // Results larger than the whole capacity are not stored.
+  void Insert(s21::Operation operation, const S21BasicMatrix<T>& matrix,
+              const S21BasicMatrix<T>& result);
+
+ private:
+  struct Key {
+    s21::Operation operation;
+    int rows;
+    int cols;
+    uint64_t hash;
+
+    bool operator==(const Key& other) const {
+      return operation == other.operation && rows == other.rows &&
+             cols == other.cols && hash == other.hash;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return key.hash ^ static_cast<size_t>(key.operation);
+    }
+  };
+
+  struct Entry {
+    Key key;
+    std::shared_ptr<const S21BasicMatrix<T>> operand;
+    std::shared_ptr<const S21BasicMatrix<T>> result;
+    size_t bytes;
+  };
+
+  using List = std::list<Entry>;
+
+  mutable std::mutex mutex_;
+  size_t capacity_;
+  size_t used_;
+  long hits_;
+  long misses_;
+  // Most recently used first
+  List entries_;
+  std::unordered_map<Key, typename List::iterator, KeyHash> index_;
+
+  // Extra functions
+  static Key MakeKey(s21::Operation operation,
+                     const S21BasicMatrix<T>& matrix);
+  void Erase(typename List::iterator entry);
+};
+
+using S21ResultCache = S21BasicResultCache<double>;
+using S21ResultCacheF = S21BasicResultCache<float>;
+
+extern template class S21BasicResultCache<float>;
+extern template class S21BasicResultCache<double>;
+
+#endif  // S21_RESULT_CACHE_H_
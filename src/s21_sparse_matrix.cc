@@ -0,0 +1,534 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_sparse_matrix.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "s21_thread_pool.h"
+
+// Constructors
+template <typename T>
+S21BasicSparseMatrix<T>::S21BasicSparseMatrix(int rows, int cols,
+                                              Format format)
+    : rows_(rows), cols_(cols), format_(format) {
+  if (rows_ <= 0 || cols_ <= 0) {
+    throw std::invalid_argument("Rows and cols must be greater than 0");
+  }
+  offsets_.assign(Lines() + 1, 0);
+}
+
+template <typename T>
+S21BasicSparseMatrix<T>::S21BasicSparseMatrix(
+    int rows, int cols, std::vector<S21SparseEntry<T>> entries, Format format)
+    : S21BasicSparseMatrix(rows, cols, format) {
+  bool csr = format_ == Format::kCsr;
+  for (const S21SparseEntry<T>& entry : entries) {
+    if (entry.row < 0 || entry.row >= rows_ || entry.col < 0 ||
+        entry.col >= cols_) {
+      throw std::out_of_range("Index is outside the matrix");
+    }
+  }
+  std::sort(entries.begin(), entries.end(),
+            [csr](const S21SparseEntry<T>& a, const S21SparseEntry<T>& b) {
+              return csr ? (a.row < b.row || (a.row == b.row && a.col < b.col))
+                         : (a.col < b.col || (a.col == b.col && a.row < b.row));
+            });
+  for (size_t p = 0; p < entries.size(); p++) {
+    int line = csr ? entries[p].row : entries[p].col;
+    int index = csr ? entries[p].col : entries[p].row;
+    if (p > 0 && line == (csr ? entries[p - 1].row : entries[p - 1].col) &&
+        index == indices_.back()) {
+      values_.back() += entries[p].value;
+    } else {
+      indices_.push_back(index);
+      values_.push_back(entries[p].value);
+      offsets_[line + 1]++;
+    }
+  }
+  for (int i = 0; i < Lines(); i++) {
+    offsets_[i + 1] += offsets_[i];
+  }
+}
+
+template <typename T>
+S21BasicSparseMatrix<T>::S21BasicSparseMatrix(const S21BasicMatrix<T>& dense,
+                                              Format format)
+    : S21BasicSparseMatrix(dense.rows_, dense.cols_) {
+  // Rows are counted in parallel, then each fills its own slice
+  s21::ParallelFor(0, rows_, dense.Size(), [&](long lo, long hi) {
+    for (long i = lo; i < hi; i++) {
+      const T* row = dense.Row(i);
+      offsets_[i + 1] = std::count_if(row, row + cols_,
+                                      [](T value) { return value != 0; });
+    }
+  });
+  for (int i = 0; i < rows_; i++) {
+    offsets_[i + 1] += offsets_[i];
+  }
+  indices_.resize(offsets_[rows_]);
+  values_.resize(offsets_[rows_]);
+  s21::ParallelFor(0, rows_, dense.Size(), [&](long lo, long hi) {
+    for (long i = lo; i < hi; i++) {
+      const T* row = dense.Row(i);
+      long p = offsets_[i];
+      for (int j = 0; j < cols_; j++) {
+        if (row[j] != 0) {
+          indices_[p] = j;
+          values_[p++] = row[j];
+        }
+      }
+    }
+  });
+  if (format != Format::kCsr) {
+    *this = ToFormat(format);
+  }
+}
+
+// Mutators
+template <typename T>
+int S21BasicSparseMatrix<T>::GetRows() const {
+  return rows_;
+}
+
+template <typename T>
+int S21BasicSparseMatrix<T>::GetCols() const {
+  return cols_;
+}
+
+template <typename T>
+long S21BasicSparseMatrix<T>::GetNonZeros() const {
+  return static_cast<long>(values_.size());
+}
+
+template <typename T>
+typename S21BasicSparseMatrix<T>::Format S21BasicSparseMatrix<T>::GetFormat()
+    const {
+  return format_;
+}
+
+template <typename T>
+const std::vector<long>& S21BasicSparseMatrix<T>::GetOffsets() const {
+  return offsets_;
+}
+
+template <typename T>
+const std::vector<int>& S21BasicSparseMatrix<T>::GetIndices() const {
+  return indices_;
+}
+
+template <typename T>
+const std::vector<T>& S21BasicSparseMatrix<T>::GetValues() const {
+  return values_;
+}
+
+// Conversion
+template <typename T>
+S21BasicMatrix<T> S21BasicSparseMatrix<T>::ToDense() const {
+  S21BasicMatrix<T> result(rows_, cols_);
+  bool csr = format_ == Format::kCsr;
+  // Lines never share an element, so they are filled in parallel
+  s21::ParallelFor(0, Lines(), GetNonZeros(), [&](long lo, long hi) {
+    for (long line = lo; line < hi; line++) {
+      for (long p = offsets_[line]; p < offsets_[line + 1]; p++) {
+        if (csr) {
+          result.Row(line)[indices_[p]] = values_[p];
+        } else {
+          result.Row(indices_[p])[line] = values_[p];
+        }
+      }
+    }
+  });
+  return result;
+}
+
+// Counting sort of the elements by their index: O(nnz + rows + cols)
+template <typename T>
+S21BasicSparseMatrix<T> S21BasicSparseMatrix<T>::ToFormat(
+    Format format) const {
+  if (format == format_) {
+    return *this;
+  }
+  S21BasicSparseMatrix result(rows_, cols_, format);
+  result.indices_.resize(values_.size());
+  result.values_.resize(values_.size());
+  for (int index : indices_) {
+    result.offsets_[index + 1]++;
+  }
+  for (int i = 0; i < result.Lines(); i++) {
+    result.offsets_[i + 1] += result.offsets_[i];
+  }
+  std::vector<long> next(result.offsets_.begin(), result.offsets_.end() - 1);
+  for (int line = 0; line < Lines(); line++) {
+    for (long p = offsets_[line]; p < offsets_[line + 1]; p++) {
+      long q = next[indices_[p]]++;
+      result.indices_[q] = line;
+      result.values_[q] = values_[p];
+    }
+  }
+  return result;
+}
+
+// Equals
+template <typename T>
+bool S21BasicSparseMatrix<T>::EqMatrix(
+    const S21BasicSparseMatrix& other) const {
+  bool flag = 1;
+  if (rows_ != other.rows_ || cols_ != other.cols_) {
+    flag = 0;
+  } else {
+    S21BasicSparseMatrix difference = Merge(other, -1);
+    for (T value : difference.values_) {
+      if (fabs(value) > S21ScalarTraits<T>::kTolerance) {
+        flag = 0;
+      }
+    }
+  }
+  return flag;
+}
+
+// Multiplication
+template <typename T>
+void S21BasicSparseMatrix<T>::MulNumber(const T num) {
+  for (T& value : values_) {
+    value *= num;
+  }
+}
+
+template <typename T>
+void S21BasicSparseMatrix<T>::MulVector(const T* x, T* y) const {
+  if (format_ == Format::kCsr) {
+    // One dot product per row, rows split between threads
+    s21::ParallelFor(0, rows_, GetNonZeros(), [&](long lo, long hi) {
+      for (long i = lo; i < hi; i++) {
+        T sum = 0;
+        for (long p = offsets_[i]; p < offsets_[i + 1]; p++) {
+          sum += values_[p] * x[indices_[p]];
+        }
+        y[i] = sum;
+      }
+    });
+  } else {
+    // Columns scatter into shared rows of y, so this stays serial
+    std::fill(y, y + rows_, T(0));
+    for (int j = 0; j < cols_; j++) {
+      for (long p = offsets_[j]; p < offsets_[j + 1]; p++) {
+        y[indices_[p]] += values_[p] * x[j];
+      }
+    }
+  }
+}
+
+// Sum
+template <typename T>
+void S21BasicSparseMatrix<T>::SumMatrix(const S21BasicSparseMatrix& other) {
+  *this = Merge(other, 1);
+}
+
+// Sub
+template <typename T>
+void S21BasicSparseMatrix<T>::SubMatrix(const S21BasicSparseMatrix& other) {
+  *this = Merge(other, -1);
+}
+
+// Transpose
+template <typename T>
+S21BasicSparseMatrix<T> S21BasicSparseMatrix<T>::Transpose() const {
+  S21BasicSparseMatrix result(*this);
+  std::swap(result.rows_, result.cols_);
+  result.format_ =
+      format_ == Format::kCsr ? Format::kCsc : Format::kCsr;
+  return result;
+}
+
+// Overloaded
+template <typename T>
+T S21BasicSparseMatrix<T>::operator()(int row, int col) const {
+  if (row >= rows_ || col >= cols_ || col < 0 || row < 0) {
+    throw std::out_of_range("Index is outside the matrix");
+  }
+  int line = format_ == Format::kCsr ? row : col;
+  int index = format_ == Format::kCsr ? col : row;
+  auto begin = indices_.begin() + offsets_[line];
+  auto end = indices_.begin() + offsets_[line + 1];
+  auto found = std::lower_bound(begin, end, index);
+  return (found != end && *found == index) ? values_[found - indices_.begin()]
+                                           : T(0);
+}
+
+template <typename T>
+bool S21BasicSparseMatrix<T>::operator==(
+    const S21BasicSparseMatrix& other) const {
+  return EqMatrix(other);
+}
+
+template <typename T>
+S21BasicSparseMatrix<T> S21BasicSparseMatrix<T>::operator+(
+    const S21BasicSparseMatrix& other) const {
+  return Merge(other, 1);
+}
+
+template <typename T>
+S21BasicSparseMatrix<T> S21BasicSparseMatrix<T>::operator-(
+    const S21BasicSparseMatrix& other) const {
+  return Merge(other, -1);
+}
+
+template <typename T>
+S21BasicSparseMatrix<T>& S21BasicSparseMatrix<T>::operator+=(
+    const S21BasicSparseMatrix& other) {
+  SumMatrix(other);
+  return *this;
+}
+
+template <typename T>
+S21BasicSparseMatrix<T>& S21BasicSparseMatrix<T>::operator-=(
+    const S21BasicSparseMatrix& other) {
+  SubMatrix(other);
+  return *this;
+}
+
+template <typename T>
+S21BasicSparseMatrix<T> S21BasicSparseMatrix<T>::operator*(
+    const T num) const {
+  S21BasicSparseMatrix result(*this);
+  result.MulNumber(num);
+  return result;
+}
+
+template <typename T>
+S21BasicSparseMatrix<T>& S21BasicSparseMatrix<T>::operator*=(const T num) {
+  MulNumber(num);
+  return *this;
+}
+
+template <typename T>
+S21BasicSparseMatrix<T> S21BasicSparseMatrix<T>::operator*(
+    const S21BasicSparseMatrix& other) const {
+  if (cols_ != other.rows_) {
+    throw std::invalid_argument(
+        "The number of columns of the first matrix is not equal to the number "
+        "of rows of the second matrix");
+  }
+  S21BasicSparseMatrix rhs = other.ToFormat(format_);
+  // (A * B)^T = B^T * A^T: CSC lines of the product come from CSC lines
+  // of B combined with CSC lines of A
+  return format_ == Format::kCsr
+             ? Product(*this, rhs, rows_, other.cols_, format_)
+             : Product(rhs, *this, rows_, other.cols_, format_);
+}
+
+template <typename T>
+S21BasicMatrix<T> S21BasicSparseMatrix<T>::operator*(
+    const S21BasicMatrix<T>& other) const {
+  if (cols_ != other.rows_) {
+    throw std::invalid_argument(
+        "The number of columns of the first matrix is not equal to the number "
+        "of rows of the second matrix");
+  }
+  if (format_ != Format::kCsr) {
+    return ToFormat(Format::kCsr) * other;
+  }
+  // Row i of the result accumulates rows of the dense operand
+  S21BasicMatrix<T> result(rows_, other.cols_);
+  int n = other.cols_;
+  s21::ParallelFor(0, rows_, GetNonZeros() * n, [&](long lo, long hi) {
+    for (long i = lo; i < hi; i++) {
+      T* out = result.Row(i);
+      for (long p = offsets_[i]; p < offsets_[i + 1]; p++) {
+        const T* in = other.Row(indices_[p]);
+        T value = values_[p];
+        for (int j = 0; j < n; j++) {
+          out[j] += value * in[j];
+        }
+      }
+    }
+  });
+  return result;
+}
+
+template <typename T>
+std::vector<T> S21BasicSparseMatrix<T>::operator*(
+    const std::vector<T>& x) const {
+  if (static_cast<long>(x.size()) != cols_) {
+    throw std::invalid_argument(
+        "The number of columns of the first matrix is not equal to the number "
+        "of rows of the second matrix");
+  }
+  std::vector<T> y(rows_);
+  MulVector(x.data(), y.data());
+  return y;
+}
+
+// Extra functions
+template <typename T>
+S21BasicMatrix<T> S21BasicSparseMatrix<T>::MulDenseLeft(
+    const S21BasicMatrix<T>& lhs) const {
+  if (lhs.cols_ != rows_) {
+    throw std::invalid_argument(
+        "The number of columns of the first matrix is not equal to the number "
+        "of rows of the second matrix");
+  }
+  S21BasicMatrix<T> result(lhs.rows_, cols_);
+  long work = static_cast<long>(lhs.rows_) * GetNonZeros();
+  s21::ParallelFor(0, lhs.rows_, work, [&](long lo, long hi) {
+    for (long i = lo; i < hi; i++) {
+      const T* in = lhs.Row(i);
+      T* out = result.Row(i);
+      if (format_ == Format::kCsr) {
+        // Scaled rows of this matrix, skipping zeros of the dense row
+        for (int k = 0; k < rows_; k++) {
+          if (in[k] != 0) {
+            for (long p = offsets_[k]; p < offsets_[k + 1]; p++) {
+              out[indices_[p]] += in[k] * values_[p];
+            }
+          }
+        }
+      } else {
+        // Dot products of the dense row with each stored column
+        for (int j = 0; j < cols_; j++) {
+          T sum = 0;
+          for (long p = offsets_[j]; p < offsets_[j + 1]; p++) {
+            sum += in[indices_[p]] * values_[p];
+          }
+          out[j] = sum;
+        }
+      }
+    }
+  });
+  return result;
+}
+
+// Lines are merged in two passes: the first sizes every merged line, the
+// second writes it at its final offset
+template <typename T>
+S21BasicSparseMatrix<T> S21BasicSparseMatrix<T>::Merge(
+    const S21BasicSparseMatrix& other, T sign) const {
+  if (rows_ != other.rows_ || cols_ != other.cols_) {
+    throw std::invalid_argument("Different matrix dimensions");
+  }
+  S21BasicSparseMatrix rhs = other.ToFormat(format_);
+  S21BasicSparseMatrix result(rows_, cols_, format_);
+  int lines = Lines();
+  long work = GetNonZeros() + rhs.GetNonZeros();
+  auto merge = [&](int line, bool write) {
+    long p = offsets_[line];
+    long q = rhs.offsets_[line];
+    long out = write ? result.offsets_[line] : 0;
+    while (p < offsets_[line + 1] || q < rhs.offsets_[line + 1]) {
+      bool take_p = q == rhs.offsets_[line + 1] ||
+                    (p < offsets_[line + 1] &&
+                     indices_[p] <= rhs.indices_[q]);
+      bool take_q = p == offsets_[line + 1] ||
+                    (q < rhs.offsets_[line + 1] &&
+                     rhs.indices_[q] <= indices_[p]);
+      if (write) {
+        result.indices_[out] = take_p ? indices_[p] : rhs.indices_[q];
+        result.values_[out] = (take_p ? values_[p] : T(0)) +
+                              (take_q ? sign * rhs.values_[q] : T(0));
+      }
+      out++;
+      p += take_p;
+      q += take_q;
+    }
+    return out;
+  };
+  s21::ParallelFor(0, lines, work, [&](long lo, long hi) {
+    for (long line = lo; line < hi; line++) {
+      result.offsets_[line + 1] = merge(line, false);
+    }
+  });
+  for (int i = 0; i < lines; i++) {
+    result.offsets_[i + 1] += result.offsets_[i];
+  }
+  result.indices_.resize(result.offsets_[lines]);
+  result.values_.resize(result.offsets_[lines]);
+  s21::ParallelFor(0, lines, work, [&](long lo, long hi) {
+    for (long line = lo; line < hi; line++) {
+      merge(line, true);
+    }
+  });
+  return result;
+}
+
+// Each line of the product is accumulated in a dense scratch row with a
+// marker per index. A symbolic pass sizes the lines, a numeric pass fills
+// them; both run on bands of lines with per-band scratch.
+template <typename T>
+S21BasicSparseMatrix<T> S21BasicSparseMatrix<T>::Product(
+    const S21BasicSparseMatrix& first, const S21BasicSparseMatrix& second,
+    int rows, int cols, Format format) {
+  S21BasicSparseMatrix result(rows, cols, format);
+  int lines = first.Lines();
+  int line_size = second.LineSize();
+  long work = first.GetNonZeros() + second.GetNonZeros();
+  s21::ParallelFor(0, lines, work, [&](long lo, long hi) {
+    std::vector<long> marker(line_size, -1);
+    for (long line = lo; line < hi; line++) {
+      long count = 0;
+      for (long p = first.offsets_[line]; p < first.offsets_[line + 1];
+           p++) {
+        int k = first.indices_[p];
+        for (long q = second.offsets_[k]; q < second.offsets_[k + 1]; q++) {
+          if (marker[second.indices_[q]] != line) {
+            marker[second.indices_[q]] = line;
+            count++;
+          }
+        }
+      }
+      result.offsets_[line + 1] = count;
+    }
+  });
+  for (int i = 0; i < lines; i++) {
+    result.offsets_[i + 1] += result.offsets_[i];
+  }
+  result.indices_.resize(result.offsets_[lines]);
+  result.values_.resize(result.offsets_[lines]);
+  s21::ParallelFor(0, lines, work, [&](long lo, long hi) {
+    std::vector<long> marker(line_size, -1);
+    std::vector<T> accumulator(line_size);
+    for (long line = lo; line < hi; line++) {
+      int* indices = result.indices_.data() + result.offsets_[line];
+      long count = 0;
+      for (long p = first.offsets_[line]; p < first.offsets_[line + 1];
+           p++) {
+        int k = first.indices_[p];
+        T value = first.values_[p];
+        for (long q = second.offsets_[k]; q < second.offsets_[k + 1]; q++) {
+          int index = second.indices_[q];
+          if (marker[index] != line) {
+            marker[index] = line;
+            accumulator[index] = 0;
+            indices[count++] = index;
+          }
+          accumulator[index] += value * second.values_[q];
+        }
+      }
+      std::sort(indices, indices + count);
+      T* values = result.values_.data() + result.offsets_[line];
+      for (long p = 0; p < count; p++) {
+        values[p] = accumulator[indices[p]];
+      }
+    }
+  });
+  return result;
+}
+
+template class S21BasicSparseMatrix<float>;
+template class S21BasicSparseMatrix<double>;
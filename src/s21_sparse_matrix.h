@@ -0,0 +1,127 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_SPARSE_MATRIX_H_
+#define S21_SPARSE_MATRIX_H_
+
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+// One stored element for building a sparse matrix
+template <typename T>
+struct S21SparseEntry {
+  int row;
+  int col;
+  T value;
+};
+
+// Compressed sparse matrix: memory grows with the number of stored
+// elements, not with rows * cols. In CSR each row is a line: its elements
+// are values[offsets[i] .. offsets[i + 1]) with sorted column numbers in
+// indices. CSC stores columns as lines and row numbers in indices.
+template <typename T>
+class S21BasicSparseMatrix {
+ public:
+  using Scalar = T;
+  enum class Format { kCsr, kCsc };
+
+  // Constructors
+  S21BasicSparseMatrix(int rows, int cols, Format format = Format::kCsr);
+  // Entries may come in any order; duplicates are summed
+  S21BasicSparseMatrix(int rows, int cols,
+                       std::vector<S21SparseEntry<T>> entries,
+                       Format format = Format::kCsr);
+  // Keeps the nonzero elements of a dense matrix
+  explicit S21BasicSparseMatrix(const S21BasicMatrix<T>& dense,
+                                Format format = Format::kCsr);
+
+  // Mutators
+  int GetRows() const;
+  int GetCols() const;
+  long GetNonZeros() const;
+  Format GetFormat() const;
+  const std::vector<long>& GetOffsets() const;
+  const std::vector<int>& GetIndices() const;
+  const std::vector<T>& GetValues() const;
+
+  // Conversion
+  S21BasicMatrix<T> ToDense() const;
+  S21BasicSparseMatrix ToFormat(Format format) const;
+
+  // Equals
+  bool EqMatrix(const S21BasicSparseMatrix& other) const;
+
+  // Multiplication
+  void MulNumber(const T num);
+  // y = A * x for x of GetCols() and y of GetRows() elements
+  void MulVector(const T* x, T* y) const;
+
+  // Sum
+  void SumMatrix(const S21BasicSparseMatrix& other);
+
+  // Sub
+  void SubMatrix(const S21BasicSparseMatrix& other);
+
+  // Transpose
+  // The transpose of a CSR matrix is the same arrays read as CSC
+  S21BasicSparseMatrix Transpose() const;
+
+  // Overloaded
+  T operator()(int row, int col) const;
+  bool operator==(const S21BasicSparseMatrix& other) const;
+  S21BasicSparseMatrix operator+(const S21BasicSparseMatrix& other) const;
+  S21BasicSparseMatrix operator-(const S21BasicSparseMatrix& other) const;
+  S21BasicSparseMatrix& operator+=(const S21BasicSparseMatrix& other);
+  S21BasicSparseMatrix& operator-=(const S21BasicSparseMatrix& other);
+  S21BasicSparseMatrix operator*(const T num) const;
+  S21BasicSparseMatrix& operator*=(const T num);
+  S21BasicSparseMatrix operator*(const S21BasicSparseMatrix& other) const;
+  S21BasicMatrix<T> operator*(const S21BasicMatrix<T>& other) const;
+  std::vector<T> operator*(const std::vector<T>& x) const;
+  friend S21BasicMatrix<T> operator*(const S21BasicMatrix<T>& lhs,
+                                     const S21BasicSparseMatrix& rhs) {
+    return rhs.MulDenseLeft(lhs);
+  }
+
+ private:
+  int rows_;
+  int cols_;
+  Format format_;
+  std::vector<long> offsets_;
+  std::vector<int> indices_;
+  std::vector<T> values_;
+
+  // Extra functions
+  int Lines() const { return format_ == Format::kCsr ? rows_ : cols_; }
+  int LineSize() const { return format_ == Format::kCsr ? cols_ : rows_; }
+  S21BasicMatrix<T> MulDenseLeft(const S21BasicMatrix<T>& lhs) const;
+  // Element-wise sign * other + this, line by line
+  S21BasicSparseMatrix Merge(const S21BasicSparseMatrix& other,
+                             T sign) const;
+  // Gustavson's row-by-row product of two matrices in the same format,
+  // taken as lines of `first` times lines of `second`
+  static S21BasicSparseMatrix Product(const S21BasicSparseMatrix& first,
+                                      const S21BasicSparseMatrix& second,
+                                      int rows, int cols, Format format);
+};
+
+using S21SparseMatrix = S21BasicSparseMatrix<double>;
+using S21SparseMatrixF = S21BasicSparseMatrix<float>;
+
+extern template class S21BasicSparseMatrix<float>;
+extern template class S21BasicSparseMatrix<double>;
+
+#endif  // S21_SPARSE_MATRIX_H_
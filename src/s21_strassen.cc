@@ -0,0 +1,277 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_strassen.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "s21_gemm.h"
+#include "s21_thread_pool.h"
+
+namespace s21 {
+
+namespace {
+
+// Default measured on one AVX2 core: at 1024 one level only breaks
+// even, at 2048 two levels save 10%
+std::atomic<int> crossover{1024};
+constexpr int kProducts = 7;
+
+// Strided operand or temporary
+template <typename T>
+struct Block {
+  const T* data;
+  int rs;
+  int cs;
+
+  Block At(int row, int col) const {
+    return {data + static_cast<long>(row) * rs + static_cast<long>(col) * cs,
+            rs, cs};
+  }
+};
+
+template <typename T>
+Block<T> Dense(const T* data, int ld) {
+  return {data, ld, 1};
+}
+
+// The crossover is read once per product and passed down, so that the
+// workspace is sized for the recursion that actually runs
+bool Splits(int m, int n, int k, int size) {
+  return size > 0 && std::min({m, n, k}) > size;
+}
+
+// out = x + sign * y element by element; out may be x or y. Split by
+// rows across the pool, or inline inside a parallel product.
+template <typename T>
+void Combine(int rows, int cols, Block<T> x, Block<T> y, T sign, T* out,
+             int ldo) {
+  long work = static_cast<long>(rows) * cols;
+  ParallelFor(0, rows, work, [&](long lo, long hi) {
+    for (long i = lo; i < hi; i++) {
+      const T* row_x = x.data + i * x.rs;
+      const T* row_y = y.data + i * y.rs;
+      T* row_out = out + i * ldo;
+      for (int j = 0; j < cols; j++) {
+        row_out[j] = row_x[static_cast<long>(j) * x.cs] +
+                     sign * row_y[static_cast<long>(j) * y.cs];
+      }
+    }
+  });
+}
+
+// Elements of workspace that Serial() needs for an m x n x k product
+long SerialWorkspace(int m, int n, int k, int size) {
+  if (!Splits(m, n, k, size)) return 0;
+  int mh = m / 2;
+  int nh = n / 2;
+  int kh = k / 2;
+  return static_cast<long>(mh) * std::max(kh, nh) +
+         static_cast<long>(kh) * nh + SerialWorkspace(mh, nh, kh, size);
+}
+
+
+// Multiplies the even-sized leading part by quadrants(), then adds what
+// the odd last row, column or inner index contributes
+template <typename T, typename Quadrants>
+void Peel(int m, int n, int k, Block<T> a, Block<T> b, T* c, int ldc,
+          Quadrants quadrants) {
+  int me = m & ~1;
+  int ne = n & ~1;
+  int ke = k & ~1;
+  quadrants(me / 2, ne / 2, ke / 2);
+  if (k != ke) {
+    Block<T> column = a.At(0, ke);
+    Block<T> row = b.At(ke, 0);
+    Gemm(me, ne, 1, 1, column.data, column.rs, column.cs, row.data, row.rs,
+         row.cs, 1, c, ldc);
+  }
+  if (n != ne) {
+    Block<T> column = b.At(0, ne);
+    Gemm(me, 1, k, 1, a.data, a.rs, a.cs, column.data, column.rs,
+         column.cs, 0, c + ne, ldc);
+  }
+  if (m != me) {
+    Block<T> row = a.At(me, 0);
+    Gemm(1, n, k, 1, row.data, row.rs, row.cs, b.data, b.rs, b.cs, 0,
+         c + static_cast<long>(me) * ldc, ldc);
+  }
+}
+
+// Two temporaries per level: X for the sums of A and then P1, Y for the
+// sums of B. Products go straight into the quadrants of C and are
+// combined there in place (Boyer, Dumas, Pernet and Zhou, 2009).
+template <typename T>
+void Serial(int m, int n, int k, Block<T> a, Block<T> b, T* c, int ldc,
+            int size, T* work) {
+  if (!Splits(m, n, k, size)) {
+    Gemm(m, n, k, 1, a.data, a.rs, a.cs, b.data, b.rs, b.cs, 0, c, ldc);
+    return;
+  }
+  Peel(m, n, k, a, b, c, ldc, [&](int mh, int nh, int kh) {
+    Block<T> a11 = a, a12 = a.At(0, kh), a21 = a.At(mh, 0);
+    Block<T> a22 = a.At(mh, kh);
+    Block<T> b11 = b, b12 = b.At(0, nh), b21 = b.At(kh, 0);
+    Block<T> b22 = b.At(kh, nh);
+    T* c11 = c;
+    T* c12 = c + nh;
+    T* c21 = c + static_cast<long>(mh) * ldc;
+    T* c22 = c21 + nh;
+    T* x = work;
+    T* y = x + static_cast<long>(mh) * std::max(kh, nh);
+    T* next = y + static_cast<long>(kh) * nh;
+    // P7 = (A11 - A21) * (B22 - B12) into C21
+    Combine(mh, kh, a11, a21, T(-1), x, kh);
+    Combine(kh, nh, b22, b12, T(-1), y, nh);
+    Serial(mh, nh, kh, Dense(x, kh), Dense(y, nh), c21, ldc, size, next);
+    // P5 = S1 * T1 into C22 with S1 = A21 + A22, T1 = B12 - B11
+    Combine(mh, kh, a21, a22, T(1), x, kh);
+    Combine(kh, nh, b12, b11, T(-1), y, nh);
+    Serial(mh, nh, kh, Dense(x, kh), Dense(y, nh), c22, ldc, size, next);
+    // P6 = S2 * T2 into C12 with S2 = S1 - A11, T2 = B22 - T1
+    Combine(mh, kh, Dense(x, kh), a11, T(-1), x, kh);
+    Combine(kh, nh, b22, Dense(y, nh), T(-1), y, nh);
+    Serial(mh, nh, kh, Dense(x, kh), Dense(y, nh), c12, ldc, size, next);
+    // P3 = (A12 - S2) * B22 into C11
+    Combine(mh, kh, a12, Dense(x, kh), T(-1), x, kh);
+    Serial(mh, nh, kh, Dense(x, kh), b22, c11, ldc, size, next);
+    // P1 = A11 * B11 into X, then C12 = P1 + P6 + P5 + P3,
+    // C21 = P1 + P6 + P7 and C22 = P1 + P6 + P7 + P5
+    Serial(mh, nh, kh, a11, b11, x, nh, size, next);
+    Combine(mh, nh, Dense(x, nh), Dense(c12, ldc), T(1), c12, ldc);
+    Combine(mh, nh, Dense(c12, ldc), Dense(c21, ldc), T(1), c21, ldc);
+    Combine(mh, nh, Dense(c12, ldc), Dense(c22, ldc), T(1), c12, ldc);
+    Combine(mh, nh, Dense(c21, ldc), Dense(c22, ldc), T(1), c22, ldc);
+    Combine(mh, nh, Dense(c12, ldc), Dense(c11, ldc), T(1), c12, ldc);
+    // P4 = A22 * (T2 - B21), subtracted from C21
+    Combine(kh, nh, Dense(y, nh), b21, T(-1), y, nh);
+    Serial(mh, nh, kh, a22, Dense(y, nh), c11, ldc, size, next);
+    Combine(mh, nh, Dense(c21, ldc), Dense(c11, ldc), T(-1), c21, ldc);
+    // C11 = P2 + P1 with P2 = A12 * B21
+    Serial(mh, nh, kh, a12, b21, c11, ldc, size, next);
+    Combine(mh, nh, Dense(c11, ldc), Dense(x, nh), T(1), c11, ldc);
+  });
+}
+
+// All eight sums first, then the seven products at once, each with its
+// own share of the workspace, then the same combination as Serial().
+// Every product runs on one thread, so this only pays while seven tasks
+// keep the whole pool busy.
+template <typename T>
+void Parallel(int m, int n, int k, Block<T> a, Block<T> b, T* c, int ldc,
+              int size) {
+  Peel(m, n, k, a, b, c, ldc, [&](int mh, int nh, int kh) {
+    long sum_a = static_cast<long>(mh) * kh;
+    long sum_b = static_cast<long>(kh) * nh;
+    long product = static_cast<long>(mh) * nh;
+    long serial = SerialWorkspace(mh, nh, kh, size);
+    std::unique_ptr<T[]> work(
+        new T[4 * sum_a + 4 * sum_b + 3 * product + 7 * serial]);
+    T* s[4];
+    T* t[4];
+    T* p[3];
+    for (int i = 0; i < 4; i++) {
+      s[i] = work.get() + i * sum_a;
+      t[i] = work.get() + 4 * sum_a + i * sum_b;
+    }
+    for (int i = 0; i < 3; i++) {
+      p[i] = work.get() + 4 * sum_a + 4 * sum_b + i * product;
+    }
+    T* serial_work = p[2] + product;
+    Block<T> a11 = a, a12 = a.At(0, kh), a21 = a.At(mh, 0);
+    Block<T> a22 = a.At(mh, kh);
+    Block<T> b11 = b, b12 = b.At(0, nh), b21 = b.At(kh, 0);
+    Block<T> b22 = b.At(kh, nh);
+    T* c11 = c;
+    T* c12 = c + nh;
+    T* c21 = c + static_cast<long>(mh) * ldc;
+    T* c22 = c21 + nh;
+    // S1..S4 and T1..T4 as in Serial()
+    Combine(mh, kh, a21, a22, T(1), s[0], kh);
+    Combine(mh, kh, Dense(s[0], kh), a11, T(-1), s[1], kh);
+    Combine(mh, kh, a11, a21, T(-1), s[2], kh);
+    Combine(mh, kh, a12, Dense(s[1], kh), T(-1), s[3], kh);
+    Combine(kh, nh, b12, b11, T(-1), t[0], nh);
+    Combine(kh, nh, b22, Dense(t[0], nh), T(-1), t[1], nh);
+    Combine(kh, nh, b22, b12, T(-1), t[2], nh);
+    Combine(kh, nh, Dense(t[1], nh), b21, T(-1), t[3], nh);
+    // P1..P7; P3, P5, P6 and P7 land in C where Serial() puts them
+    struct Product {
+      Block<T> a;
+      Block<T> b;
+      T* c;
+      int ldc;
+    };
+    const Product products[7] = {
+        {a11, b11, p[0], nh},
+        {a12, b21, p[1], nh},
+        {Dense(s[3], kh), b22, c11, ldc},
+        {a22, Dense(t[3], nh), p[2], nh},
+        {Dense(s[0], kh), Dense(t[0], nh), c22, ldc},
+        {Dense(s[1], kh), Dense(t[1], nh), c12, ldc},
+        {Dense(s[2], kh), Dense(t[2], nh), c21, ldc}};
+    ThreadPool::Instance().ParallelFor(0, 7, 1, [&](long lo, long hi) {
+      for (long i = lo; i < hi; i++) {
+        Serial(mh, nh, kh, products[i].a, products[i].b, products[i].c,
+               products[i].ldc, size, serial_work + i * serial);
+      }
+    });
+    Combine(mh, nh, Dense(p[0], nh), Dense(c12, ldc), T(1), c12, ldc);
+    Combine(mh, nh, Dense(c12, ldc), Dense(c21, ldc), T(1), c21, ldc);
+    Combine(mh, nh, Dense(c12, ldc), Dense(c22, ldc), T(1), c12, ldc);
+    Combine(mh, nh, Dense(c21, ldc), Dense(c22, ldc), T(1), c22, ldc);
+    Combine(mh, nh, Dense(c12, ldc), Dense(c11, ldc), T(1), c12, ldc);
+    Combine(mh, nh, Dense(c21, ldc), Dense(p[2], nh), T(-1), c21, ldc);
+    Combine(mh, nh, Dense(p[0], nh), Dense(p[1], nh), T(1), c11, ldc);
+  });
+}
+
+template <typename T>
+void Multiply(int m, int n, int k, const T* a, int rsa, int csa, const T* b,
+              int rsb, int csb, T* c, int ldc) {
+  Block<T> block_a{a, rsa, csa};
+  Block<T> block_b{b, rsb, csb};
+  int size = crossover;
+  int threads = GetNumThreads();
+  if (!Splits(m, n, k, size)) {
+    Gemm(m, n, k, 1, a, rsa, csa, b, rsb, csb, 0, c, ldc);
+  } else if (threads > 1 && threads <= kProducts) {
+    Parallel(m, n, k, block_a, block_b, c, ldc, size);
+  } else {
+    // On a wider pool the leaf Gemm calls and the sums use every thread
+    std::unique_ptr<T[]> work(new T[SerialWorkspace(m, n, k, size)]);
+    Serial(m, n, k, block_a, block_b, c, ldc, size, work.get());
+  }
+}
+
+}  // namespace
+
+void Strassen(int m, int n, int k, const double* a, int rsa, int csa,
+              const double* b, int rsb, int csb, double* c, int ldc) {
+  Multiply(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc);
+}
+
+void Strassen(int m, int n, int k, const float* a, int rsa, int csa,
+              const float* b, int rsb, int csb, float* c, int ldc) {
+  Multiply(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc);
+}
+
+void SetStrassenCrossover(int size) { crossover = size; }
+
+int GetStrassenCrossover() { return crossover; }
+
+}  // namespace s21
@@ -0,0 +1,44 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_STRASSEN_H_
+#define S21_STRASSEN_H_
+
+namespace s21 {
+
+// C = A * B for an m x k matrix A and a k x n matrix B, strided as in
+// Gemm. While every dimension is above the crossover the product is
+// split into quadrants and formed from seven half-size products
+// (Strassen-Winograd); otherwise, or when the crossover is 0, Gemm runs.
+// Odd dimensions are peeled off and added by Gemm. The temporaries of
+// the whole recursion come from one workspace allocated up front. With
+// two to seven threads the seven top-level products run in parallel;
+// with more, each leaf Gemm call uses the whole pool.
+//
+// Each level trades one eighth of the multiplications for 15 additions
+// of quarter size, and the error bound grows by a small factor per
+// level, so results differ from Gemm in the last bits.
+void Strassen(int m, int n, int k, const double* a, int rsa, int csa,
+              const double* b, int rsb, int csb, double* c, int ldc);
+void Strassen(int m, int n, int k, const float* a, int rsa, int csa,
+              const float* b, int rsb, int csb, float* c, int ldc);
+
+// Largest dimension that is not split any further
+void SetStrassenCrossover(int size);
+int GetStrassenCrossover();
+
+}  // namespace s21
+
+#endif  // S21_STRASSEN_H_
@@ -0,0 +1,242 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_thread_pool.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <exception>
+
+namespace s21 {
+
+namespace {
+
+// Set while a thread runs pool work, so nested parallel calls run inline
+// instead of multiplying the number of busy threads
+thread_local bool in_parallel_region = false;
+
+std::atomic<long> parallel_threshold{1L << 16};
+
+int DefaultThreads() {
+  const char* env = getenv("S21_NUM_THREADS");
+  int threads = env != nullptr ? atoi(env) : 0;
+  if (threads <= 0) {
+    threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  return std::max(threads, 1);
+}
+
+}  // namespace
+
+// Constructors
+ThreadPool::ThreadPool()
+    : threads_(0), pending_(0), next_queue_(0), busy_(false), stop_(false) {
+  Start(DefaultThreads());
+}
+
+ThreadPool& ThreadPool::Instance() {
+  static ThreadPool pool;
+  return pool;
+}
+
+// Destructors
+ThreadPool::~ThreadPool() { Stop(); }
+
+// Accessors
+int ThreadPool::GetNumThreads() const { return threads_; }
+
+// Mutators
+void ThreadPool::SetNumThreads(int threads) {
+  if (threads <= 0) {
+    throw std::invalid_argument("Thread count must be greater than 0");
+  }
+  if (threads != threads_) {
+    Stop();
+    Start(threads);
+  }
+}
+
+void ThreadPool::ParallelFor(long begin, long end, long grain,
+                             const std::function<void(long, long)>& body) {
+  long size = end - begin;
+  grain = std::max(grain, 1L);
+  if (size <= 0) {
+    return;
+  }
+  if (threads_ == 1 || in_parallel_region || size <= grain ||
+      busy_.exchange(true, std::memory_order_acquire)) {
+    body(begin, end);
+    return;
+  }
+  long chunks = std::min((size + grain - 1) / grain, 4L * threads_);
+  long step = (size + chunks - 1) / chunks;
+  // Guarded by done_mutex, so the last chunk has released it before the
+  // caller can see zero and return
+  long remaining = 0;
+  std::mutex done_mutex;
+  std::condition_variable done;
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  for (long lo = begin + step; lo < end; lo += step) {
+    long hi = std::min(lo + step, end);
+    {
+      std::lock_guard<std::mutex> lock(done_mutex);
+      remaining++;
+    }
+    Push([&, lo, hi] {
+      try {
+        body(lo, hi);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+      std::lock_guard<std::mutex> lock(done_mutex);
+      if (--remaining == 0) {
+        done.notify_one();
+      }
+    });
+  }
+  // The caller takes the first chunk itself and then helps with the rest
+  in_parallel_region = true;
+  try {
+    body(begin, std::min(begin + step, end));
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(error_mutex);
+    if (!error) {
+      error = std::current_exception();
+    }
+  }
+  // Only this region's chunks are queued: nested regions run inline
+  while (TryRun(-1)) {
+  }
+  {
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done.wait(lock, [&] { return remaining == 0; });
+  }
+  in_parallel_region = false;
+  busy_.store(false, std::memory_order_release);
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+// Extra functions
+void ThreadPool::Start(int threads) {
+  threads_ = threads;
+  stop_ = false;
+  // The calling thread is the last participant, so it gets no worker
+  for (int i = 0; i < threads - 1; i++) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (int i = 0; i < threads - 1; i++) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+void ThreadPool::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  queues_.clear();
+}
+
+void ThreadPool::WorkerLoop(int index) {
+  in_parallel_region = true;
+  for (;;) {
+    if (TryRun(index)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this] { return stop_ || pending_ > 0; });
+    if (stop_ && pending_ == 0) {
+      break;
+    }
+  }
+}
+
+void ThreadPool::Push(Task task) {
+  Queue& queue = *queues_[next_queue_++ % queues_.size()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    pending_++;
+  }
+  wake_.notify_one();
+}
+
+// Runs one task: from the back of the own deque first, otherwise stolen
+// from the front of another one. index -1 means a non-worker thread.
+bool ThreadPool::TryRun(int index) {
+  Task task;
+  int count = static_cast<int>(queues_.size());
+  for (int attempt = 0; attempt < count && !task; attempt++) {
+    int victim = (index < 0 ? attempt : index + attempt) % count;
+    Queue& queue = *queues_[victim];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      if (victim == index) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      } else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+    }
+  }
+  if (task) {
+    pending_--;
+    task();
+  }
+  return static_cast<bool>(task);
+}
+
+void SetNumThreads(int threads) {
+  ThreadPool::Instance().SetNumThreads(threads);
+}
+
+int GetNumThreads() { return ThreadPool::Instance().GetNumThreads(); }
+
+void SetParallelThreshold(long work) { parallel_threshold = work; }
+
+long GetParallelThreshold() { return parallel_threshold; }
+
+void ParallelFor(long begin, long end, long work,
+                 const std::function<void(long, long)>& body) {
+  long size = end - begin;
+  if (size <= 0) {
+    return;
+  }
+  if (work <= parallel_threshold) {
+    body(begin, end);
+    return;
+  }
+  // Enough iterations per chunk to cover roughly one threshold of work
+  long grain = std::max(1L, parallel_threshold * size / work);
+  ThreadPool::Instance().ParallelFor(begin, end, grain, body);
+}
+
+}  // namespace s21
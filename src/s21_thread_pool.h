@@ -0,0 +1,100 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_THREAD_POOL_H_
+#define S21_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+
+// Process-wide pool of worker threads, each with its own task deque.
+// Workers pop from the back of their own deque and steal from the front
+// of the others; the submitting thread helps while there are queued
+// chunks and then sleeps until the last one is done.
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  static ThreadPool& Instance();
+
+  ~ThreadPool();
+
+  // Accessors
+  int GetNumThreads() const;
+
+  // Mutators. Must not be called while parallel work is running.
+  void SetNumThreads(int threads);
+
+  // Runs body(lo, hi) over disjoint chunks covering [begin, end), each at
+  // least grain long. Nested calls and calls from pool workers run inline,
+  // and so do calls from other threads while one region holds the pool:
+  // the pool serves one parallel region at a time. Each inline caller
+  // still adds its own thread on top of the workers.
+  void ParallelFor(long begin, long end, long grain,
+                   const std::function<void(long, long)>& body);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void Start(int threads);
+  void Stop();
+  void WorkerLoop(int index);
+  void Push(Task task);
+  bool TryRun(int index);
+
+  int threads_;
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<long> pending_;
+  std::atomic<unsigned> next_queue_;
+  // Set while a top-level region has its chunks in the pool
+  std::atomic<bool> busy_;
+  bool stop_;
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+};
+
+// Thread count used by the matrix kernels. Defaults to the S21_NUM_THREADS
+// environment variable, or the hardware concurrency when it is unset.
+void SetNumThreads(int threads);
+int GetNumThreads();
+
+// Minimal amount of scalar work (elements, or multiply-adds for products)
+// before an operation is split across threads
+void SetParallelThreshold(long work);
+long GetParallelThreshold();
+
+// Splits [begin, end) across the pool when work exceeds the threshold
+void ParallelFor(long begin, long end, long work,
+                 const std::function<void(long, long)>& body);
+
+}  // namespace s21
+
+#endif  // S21_THREAD_POOL_H_
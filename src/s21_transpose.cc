@@ -0,0 +1,232 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "s21_transpose.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "s21_thread_pool.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define S21_TRANSPOSE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace s21 {
+
+namespace {
+
+// The recursion stops at tiles whose source and destination both fit in L1
+constexpr int kTile = 32;
+
+// Transposes a square block of BlockInfo::size elements in registers
+template <typename T>
+using BlockKernel = void (*)(const T* a, int lda, T* b, int ldb);
+
+template <typename T>
+struct BlockInfo {
+  BlockKernel<T> kernel;
+  int size;
+};
+
+template <typename T>
+void BlockGeneric(const T* a, int lda, T* b, int ldb) {
+  b[0] = a[0];
+  b[1] = a[lda];
+  b[ldb] = a[1];
+  b[ldb + 1] = a[lda + 1];
+}
+
+#ifdef S21_TRANSPOSE_X86
+void BlockSse2(const double* a, int lda, double* b, int ldb) {
+  __m128d r0 = _mm_loadu_pd(a);
+  __m128d r1 = _mm_loadu_pd(a + lda);
+  _mm_storeu_pd(b, _mm_unpacklo_pd(r0, r1));
+  _mm_storeu_pd(b + ldb, _mm_unpackhi_pd(r0, r1));
+}
+
+void BlockSse2(const float* a, int lda, float* b, int ldb) {
+  __m128 r0 = _mm_loadu_ps(a);
+  __m128 r1 = _mm_loadu_ps(a + lda);
+  __m128 r2 = _mm_loadu_ps(a + 2 * lda);
+  __m128 r3 = _mm_loadu_ps(a + 3 * lda);
+  _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+  _mm_storeu_ps(b, r0);
+  _mm_storeu_ps(b + ldb, r1);
+  _mm_storeu_ps(b + 2 * ldb, r2);
+  _mm_storeu_ps(b + 3 * ldb, r3);
+}
+
+__attribute__((target("avx"))) void BlockAvx(const double* a, int lda,
+                                             double* b, int ldb) {
+  __m256d r0 = _mm256_loadu_pd(a);
+  __m256d r1 = _mm256_loadu_pd(a + lda);
+  __m256d r2 = _mm256_loadu_pd(a + 2 * lda);
+  __m256d r3 = _mm256_loadu_pd(a + 3 * lda);
+  // Pairs of rows interleaved within each 128-bit lane, then lanes swapped
+  __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+  __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+  __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+  __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+  _mm256_storeu_pd(b, _mm256_permute2f128_pd(t0, t2, 0x20));
+  _mm256_storeu_pd(b + ldb, _mm256_permute2f128_pd(t1, t3, 0x20));
+  _mm256_storeu_pd(b + 2 * ldb, _mm256_permute2f128_pd(t0, t2, 0x31));
+  _mm256_storeu_pd(b + 3 * ldb, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+__attribute__((target("avx"))) void BlockAvx(const float* a, int lda,
+                                             float* b, int ldb) {
+  __m256 r[8];
+  for (int i = 0; i < 8; i++) {
+    r[i] = _mm256_loadu_ps(a + i * lda);
+  }
+  __m256 t[8];
+  for (int i = 0; i < 8; i += 2) {
+    t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+    t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+  }
+  __m256 s[8];
+  for (int i = 0; i < 8; i += 4) {
+    s[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+    s[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+    s[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+    s[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+  }
+  for (int i = 0; i < 4; i++) {
+    _mm256_storeu_ps(b + i * ldb, _mm256_permute2f128_ps(s[i], s[i + 4], 0x20));
+    _mm256_storeu_ps(b + (i + 4) * ldb,
+                     _mm256_permute2f128_ps(s[i], s[i + 4], 0x31));
+  }
+}
+#endif
+
+template <typename T>
+const BlockInfo<T>& SelectBlock() {
+  static const BlockInfo<T> info = [] {
+#ifdef S21_TRANSPOSE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+      return BlockInfo<T>{BlockAvx, static_cast<int>(32 / sizeof(T))};
+    }
+    return BlockInfo<T>{BlockSse2, static_cast<int>(16 / sizeof(T))};
+#else
+    return BlockInfo<T>{BlockGeneric<T>, 2};
+#endif
+  }();
+  return info;
+}
+
+// Register blocks over the interior of a tile, scalar copies at the edges
+template <typename T>
+void TransposeTile(int rows, int cols, const T* a, int lda, T* b, int ldb) {
+  const BlockInfo<T>& info = SelectBlock<T>();
+  int full_rows = rows - rows % info.size;
+  int full_cols = cols - cols % info.size;
+  for (int i = 0; i < full_rows; i += info.size) {
+    for (int j = 0; j < full_cols; j += info.size) {
+      info.kernel(a + static_cast<long>(i) * lda + j, lda,
+                  b + static_cast<long>(j) * ldb + i, ldb);
+    }
+  }
+  for (int i = 0; i < rows; i++) {
+    for (int j = (i < full_rows) ? full_cols : 0; j < cols; j++) {
+      b[static_cast<long>(j) * ldb + i] = a[static_cast<long>(i) * lda + j];
+    }
+  }
+}
+
+// Cache-oblivious: halves the longer side until a tile fits in L1, so every
+// level of the cache hierarchy sees blocks of a suitable size
+template <typename T>
+void TransposeRecursive(int rows, int cols, const T* a, int lda, T* b,
+                        int ldb) {
+  if (rows <= kTile && cols <= kTile) {
+    TransposeTile(rows, cols, a, lda, b, ldb);
+  } else if (rows >= cols) {
+    int half = rows / 2;
+    TransposeRecursive(half, cols, a, lda, b, ldb);
+    TransposeRecursive(rows - half, cols, a + static_cast<long>(half) * lda,
+                       lda, b + half, ldb);
+  } else {
+    int half = cols / 2;
+    TransposeRecursive(rows, half, a, lda, b, ldb);
+    TransposeRecursive(rows, cols - half, a + half, lda,
+                       b + static_cast<long>(half) * ldb, ldb);
+  }
+}
+
+// Threads take bands of source columns, so each writes its own rows of B
+template <typename T>
+void TransposeImpl(int rows, int cols, const T* a, int lda, T* b, int ldb) {
+  long bands = (cols + kTile - 1) / kTile;
+  ParallelFor(0, bands, static_cast<long>(rows) * cols,
+              [&](long lo, long hi) {
+                int first = static_cast<int>(lo) * kTile;
+                int last = std::min(cols, static_cast<int>(hi) * kTile);
+                TransposeRecursive(rows, last - first, a + first, lda,
+                                   b + static_cast<long>(first) * ldb, ldb);
+              });
+}
+
+// Tiles above the diagonal are swapped with their mirror images through a
+// tile-sized buffer; diagonal tiles are transposed through the buffer alone
+template <typename T>
+void TransposeSquareImpl(int n, T* a, int ld) {
+  long tiles = (n + kTile - 1) / kTile;
+  ParallelFor(0, tiles, static_cast<long>(n) * n / 2, [&](long lo, long hi) {
+    T buffer[kTile * kTile];
+    for (long ti = lo; ti < hi; ti++) {
+      int i = static_cast<int>(ti) * kTile;
+      int rows = std::min(kTile, n - i);
+      for (int j = i; j < n; j += kTile) {
+        int cols = std::min(kTile, n - j);
+        T* upper = a + static_cast<long>(i) * ld + j;
+        T* lower = a + static_cast<long>(j) * ld + i;
+        for (int r = 0; r < rows; r++) {
+          memcpy(buffer + r * kTile, upper + static_cast<long>(r) * ld,
+                 sizeof(T) * cols);
+        }
+        if (j != i) {
+          TransposeTile(cols, rows, lower, ld, upper, ld);
+        }
+        TransposeTile(rows, cols, buffer, kTile, lower, ld);
+      }
+    }
+  });
+}
+
+}  // namespace
+
+void Transpose(int rows, int cols, const double* a, int lda, double* b,
+               int ldb) {
+  TransposeImpl(rows, cols, a, lda, b, ldb);
+}
+
+void Transpose(int rows, int cols, const float* a, int lda, float* b,
+               int ldb) {
+  TransposeImpl(rows, cols, a, lda, b, ldb);
+}
+
+void TransposeSquare(int n, double* a, int ld) {
+  TransposeSquareImpl(n, a, ld);
+}
+
+void TransposeSquare(int n, float* a, int ld) {
+  TransposeSquareImpl(n, a, ld);
+}
+
+}  // namespace s21
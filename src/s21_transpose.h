@@ -0,0 +1,34 @@
+/* Copyright 08.02.2023 Dmitry S
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef S21_TRANSPOSE_H_
+#define S21_TRANSPOSE_H_
+
+namespace s21 {
+
+// B = A^T for a rows x cols matrix A with leading dimension lda. B is
+// cols x rows with leading dimension ldb and must not overlap A.
+void Transpose(int rows, int cols, const double* a, int lda, double* b,
+               int ldb);
+void Transpose(int rows, int cols, const float* a, int lda, float* b,
+               int ldb);
+
+// Transposes an n x n matrix with leading dimension ld in place
+void TransposeSquare(int n, double* a, int ld);
+void TransposeSquare(int n, float* a, int ld);
+
+}  // namespace s21
+
+#endif  // S21_TRANSPOSE_H_